@@ -0,0 +1,489 @@
+/*!
+ * \file
+ * AEDEA host benchmark suite, measures the cost of the kernel primitives on the hosted Linux
+ * port: event post/get by item size, timer install/re-arm/cancel and the timer tick against
+ * the number of running timers, and the scheduler round against the number of processes.
+ *
+ * Build and run with "make run" in this directory, see the Makefile.
+ *
+ * Each line reports the mean and the percentiles of the ns/op of the samples, a sample
+ * times BATCH consecutive operations. Sampling stops after MAX_SAMPLES samples or when the
+ * benchmark's time budget is spent, whichever comes first.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+
+/*
+ * ----- Header files -----
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "platform.h"
+#include "options.h"
+#include "aedea.h"
+
+
+/*
+ * Each sample times BATCH operations, the percentiles are taken over the samples' ns/op.
+ */
+#define BATCH                 16
+#define MAX_SAMPLES           2000
+#define BUDGET_NS             2e9
+
+#define MAX_ITEM_SIZE         256
+#define MAX_TMR_TICKS         1000000UL
+#define MAX_TMR_PERIOD        1024UL
+
+#define PID_BENCH             1
+
+
+/*
+ * ----- Types -----
+ */
+typedef struct
+{
+     double ns[MAX_SAMPLES];                 // ns/op of each sample.
+     int num_samples;                        // Number of samples taken.
+}
+samples_t;
+
+
+/*
+ * ----- Local function prototypes -----
+ */
+static double now_ns(void);
+static void budget_start(void);
+static int budget_left(void);
+static unsigned long rnd(void);
+static int cmp_double(const void * a_ptr, const void * b_ptr);
+static void samples_add(samples_t * samples_ptr, double elapsed_ns, unsigned long num_ops);
+static void samples_report(const char * name_ptr, unsigned long param, samples_t * samples_ptr);
+static void run_child(void (*bench)(unsigned long), unsigned long param);
+static void tmr_handler(uint8_t timer_id, void * arg_ptr);
+static void queue_process(void * arg_ptr);
+static void bench_queue(unsigned long item_size);
+static void bench_timers(unsigned long num_timers);
+static void tick_process(void * arg_ptr);
+static void bench_tick(unsigned long num_timers);
+static void sched_process(void * arg_ptr);
+static void bench_sched(unsigned long num_procs);
+
+
+/*
+ * ----- Variables -----
+ */
+static unsigned long rng_state = 1;                         // State of the random number generator.
+static samples_t samples_a;                                 // Samples of the first measured operation.
+static samples_t samples_b;                                 // Samples of the second measured operation.
+static samples_t samples_c;                                 // Samples of the third measured operation.
+static aedea_tmr_handle_t handles[AEDEA_OPT_MAX_SOFT_TMRS]; // Handles of the installed timers.
+static uint8_t queue_buff[BATCH * MAX_ITEM_SIZE];           // Event queue of the benchmark process.
+static unsigned long queue_item_size;                       // Item size measured by queue_process().
+static unsigned long tick_num_timers;                       // Number of timers measured by tick_process().
+static unsigned long sched_num_procs;                       // Number of processes measured by sched_process().
+static unsigned long sched_calls = 0;                       // Number of sched_process() calls.
+static double sched_start_ns;                               // Start time of the current scheduler sample.
+static double budget_end_ns;                                // Time when sampling stops.
+
+
+/*
+ * ----- Function: main() -----
+ */
+int main(void)
+{
+     static const unsigned long item_sizes[] = {4, 8, 16, 32, 64, 128, 256};
+     static const unsigned long timer_counts[] = {10, 100, 1000, 10000, 100000};
+     static const unsigned long proc_counts[] = {1, 2, 4, 8, 16, 32, 63};
+     unsigned int n;
+
+     printf("%-16s %8s %8s %10s %10s %10s %10s %10s\n", "benchmark", "param", "samples", "mean", "p50", "p90", "p99", "max");
+
+     for(n = 0; n < (sizeof(item_sizes) / sizeof(item_sizes[0])); n++)
+     {
+          run_child(bench_queue, item_sizes[n]);
+     }
+
+     for(n = 0; n < (sizeof(timer_counts) / sizeof(timer_counts[0])); n++)
+     {
+          run_child(bench_timers, timer_counts[n]);
+     }
+
+     for(n = 0; n < (sizeof(timer_counts) / sizeof(timer_counts[0])); n++)
+     {
+          run_child(bench_tick, timer_counts[n]);
+     }
+
+     for(n = 0; n < (sizeof(proc_counts) / sizeof(proc_counts[0])); n++)
+     {
+          run_child(bench_sched, proc_counts[n]);
+     }
+
+     return 0;
+}
+
+
+/*
+ * ----- Function: now_ns() -----
+ */
+static double now_ns(void)
+{
+     struct timespec now;
+
+     clock_gettime(CLOCK_MONOTONIC, &now);
+
+     return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+
+/*
+ * ----- Function: budget_start() -----
+ */
+static void budget_start(void)
+{
+     budget_end_ns = now_ns() + BUDGET_NS;
+}
+
+
+/*
+ * ----- Function: budget_left() -----
+ */
+static int budget_left(void)
+{
+     return (now_ns() < budget_end_ns) ? 1 : 0;
+}
+
+
+/*
+ * ----- Function: rnd() -----
+ */
+static unsigned long rnd(void)
+{
+     // Fixed seed, so that runs are reproducible.
+     rng_state = (rng_state * 6364136223846793005UL) + 1442695040888963407UL;
+
+     return (rng_state >> 33);
+}
+
+
+/*
+ * ----- Function: cmp_double() -----
+ */
+static int cmp_double(const void * a_ptr, const void * b_ptr)
+{
+     double a = *(const double *)a_ptr;
+     double b = *(const double *)b_ptr;
+
+     return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+
+/*
+ * ----- Function: samples_add() -----
+ */
+static void samples_add(samples_t * samples_ptr, double elapsed_ns, unsigned long num_ops)
+{
+     if(samples_ptr->num_samples < MAX_SAMPLES)
+     {
+          samples_ptr->ns[samples_ptr->num_samples] = elapsed_ns / (double)num_ops;
+          samples_ptr->num_samples++;
+     }
+}
+
+
+/*
+ * ----- Function: samples_report() -----
+ */
+static void samples_report(const char * name_ptr, unsigned long param, samples_t * samples_ptr)
+{
+     double sum = 0.0;
+     int num = samples_ptr->num_samples;
+     int n;
+
+     if(0 == num)
+     {
+          return;
+     }
+
+     qsort(samples_ptr->ns, num, sizeof(double), cmp_double);
+     for(n = 0; n < num; n++)
+     {
+          sum += samples_ptr->ns[n];
+     }
+
+     printf("%-16s %8lu %8d %10.1f %10.1f %10.1f %10.1f %10.1f\n", name_ptr, param, num, sum / num,
+            samples_ptr->ns[(num * 50) / 100], samples_ptr->ns[(num * 90) / 100],
+            samples_ptr->ns[(num * 99) / 100], samples_ptr->ns[num - 1]);
+     fflush(stdout);
+}
+
+
+/*
+ * ----- Function: run_child() -----
+ */
+static void run_child(void (*bench)(unsigned long), unsigned long param)
+{
+     pid_t child;
+     int status;
+
+     // AEDEA cannot be torn down and aedea_start() does not return, every benchmark
+     // runs in a fresh process.
+     fflush(stdout);
+     child = fork();
+     if(0 == child)
+     {
+          aedea_init();
+          bench(param);
+          fflush(stdout);
+          _exit(0);
+     }
+
+     if((child < 0) || (waitpid(child, &status, 0) < 0) || !WIFEXITED(status) || (0 != WEXITSTATUS(status)))
+     {
+          fprintf(stderr, "benchmark failed (param %lu)\n", param);
+     }
+}
+
+
+/*
+ * ----- Function: tmr_handler() -----
+ */
+static void tmr_handler(uint8_t timer_id, void * arg_ptr)
+{
+     (void)timer_id;
+     (void)arg_ptr;
+}
+
+
+/*
+ * ----- Function: queue_process() -----
+ */
+static void queue_process(void * arg_ptr)
+{
+     uint8_t item[MAX_ITEM_SIZE];
+     double start;
+     int s;
+     int n;
+
+     (void)arg_ptr;
+     memset(item, 0x5A, sizeof(item));
+
+     // aedea_get_event() only works from a process callback, the whole benchmark runs in
+     // the first call.
+     budget_start();
+     for(s = 0; (s < MAX_SAMPLES) && budget_left(); s++)
+     {
+          start = now_ns();
+          for(n = 0; n < BATCH; n++)
+          {
+               aedea_post_event(PID_BENCH, item);
+          }
+          samples_add(&samples_a, now_ns() - start, BATCH);
+
+          start = now_ns();
+          for(n = 0; n < BATCH; n++)
+          {
+               aedea_get_event(item);
+          }
+          samples_add(&samples_b, now_ns() - start, BATCH);
+     }
+
+     samples_report("post_event", queue_item_size, &samples_a);
+     samples_report("get_event", queue_item_size, &samples_b);
+     fflush(stdout);
+     _exit(0);
+}
+
+
+/*
+ * ----- Function: bench_queue() -----
+ */
+static void bench_queue(unsigned long item_size)
+{
+     queue_item_size = item_size;
+     aedea_add_process(queue_process, NULL, PID_BENCH, queue_buff, BATCH, item_size);
+     aedea_start();
+}
+
+
+/*
+ * ----- Function: bench_timers() -----
+ */
+static void bench_timers(unsigned long num_timers)
+{
+     double start;
+     unsigned long n;
+     int s;
+
+     // Decreasing timeouts are inserted at the head of the delta list, so setting up a
+     // large population stays cheap with either timer structure.
+     for(n = 0; n < num_timers; n++)
+     {
+          aedea_install_timer(&(handles[n]), tmr_handler, NULL, 0, MAX_TMR_TICKS - n, AEDEA_TMR_ONE_SHOT);
+     }
+
+     budget_start();
+     for(s = 0; (s < MAX_SAMPLES) && budget_left(); s++)
+     {
+          start = now_ns();
+          for(n = num_timers; n < (num_timers + BATCH); n++)
+          {
+               aedea_install_timer(&(handles[n]), tmr_handler, NULL, 0, 1 + (rnd() % MAX_TMR_TICKS), AEDEA_TMR_ONE_SHOT);
+          }
+          samples_add(&samples_a, now_ns() - start, BATCH);
+
+          start = now_ns();
+          for(n = num_timers; n < (num_timers + BATCH); n++)
+          {
+               aedea_rearm_timer(handles[n], 1 + (rnd() % MAX_TMR_TICKS));
+          }
+          samples_add(&samples_b, now_ns() - start, BATCH);
+
+          start = now_ns();
+          for(n = num_timers; n < (num_timers + BATCH); n++)
+          {
+               aedea_cancel_timer(handles[n]);
+          }
+          samples_add(&samples_c, now_ns() - start, BATCH);
+     }
+
+     samples_report("timer_install", num_timers, &samples_a);
+     samples_report("timer_rearm", num_timers, &samples_b);
+     samples_report("timer_cancel", num_timers, &samples_c);
+}
+
+
+/*
+ * ----- Function: tick_process() -----
+ */
+static void tick_process(void * arg_ptr)
+{
+     double start;
+     unsigned long n;
+
+     (void)arg_ptr;
+
+     // One sample per call. The timer process runs between the calls and empties the
+     // expired timers queue, so the ticks pay for queueing their expiries while calling
+     // the handlers is not measured.
+     start = now_ns();
+     for(n = 0; n < BATCH; n++)
+     {
+          aedea_timer_tick();
+     }
+     samples_add(&samples_a, now_ns() - start, BATCH);
+
+     if((MAX_SAMPLES == samples_a.num_samples) || !budget_left())
+     {
+          samples_report("timer_tick", tick_num_timers, &samples_a);
+          fflush(stdout);
+          _exit(0);
+     }
+}
+
+
+/*
+ * ----- Function: bench_tick() -----
+ */
+static void bench_tick(unsigned long num_timers)
+{
+     unsigned long n;
+
+     // Periodic timers with periods spread over 1 to MAX_TMR_PERIOD ticks, so that every tick
+     // has expiries to process. They are installed longest period first, see bench_timers().
+     for(n = 0; n < num_timers; n++)
+     {
+          aedea_install_timer(&(handles[n]), tmr_handler, NULL, 0, 1 + (((num_timers - 1 - n) * MAX_TMR_PERIOD) / num_timers), AEDEA_TMR_PERIODIC);
+     }
+
+     tick_num_timers = num_timers;
+     aedea_add_process(tick_process, NULL, PID_BENCH, NULL, 0, 0);
+
+     budget_start();
+     aedea_start();
+}
+
+
+/*
+ * ----- Function: sched_process() -----
+ */
+static void sched_process(void * arg_ptr)
+{
+     double now;
+
+     (void)arg_ptr;
+
+     sched_calls++;
+     if(0 != (sched_calls % (BATCH * sched_num_procs)))
+     {
+          return;
+     }
+
+     // BATCH rounds have passed, a round calls every process once (the timer process too).
+     now = now_ns();
+     if(sched_calls > (BATCH * sched_num_procs))
+     {
+          samples_add(&samples_a, now - sched_start_ns, BATCH);
+     }
+     sched_start_ns = now;
+
+     if((MAX_SAMPLES == samples_a.num_samples) || !budget_left())
+     {
+          samples_report("sched_round", sched_num_procs, &samples_a);
+          fflush(stdout);
+          _exit(0);
+     }
+}
+
+
+/*
+ * ----- Function: bench_sched() -----
+ */
+static void bench_sched(unsigned long num_procs)
+{
+     unsigned long n;
+
+     sched_num_procs = num_procs;
+     for(n = 0; n < num_procs; n++)
+     {
+          aedea_add_process(sched_process, NULL, (uint8_t)(PID_BENCH + n), NULL, 0, 0);
+     }
+
+     budget_start();
+     aedea_start();
+}
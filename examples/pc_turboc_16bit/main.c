@@ -154,11 +154,11 @@ int16_t main(void)
      // all related fields are set to NULL.
      aedea_add_process(mouse_process, NULL, PID_MOUSE_PROCESS, NULL, NULL, NULL);
 
-     // Install the print timer timeout handler.
-     aedea_install_timeout_handler(print_timer, NULL, TMR_ID_PRINT_TIMER, TMR_INTERVAL_PRINT);
+     // Install the print timer timeout handler as a periodic timer.
+     aedea_install_timeout_handler(print_timer, NULL, TMR_ID_PRINT_TIMER, TMR_INTERVAL_PRINT, AEDEA_TMR_PERIODIC);
 
-     // Install the animation timer timeout handler.
-     aedea_install_timeout_handler(animation_timer, &ani_rect, TMR_ID_ANIMATION_TIMER, TMR_INTERVAL_ANIMATION);     
+     // Install the animation timer timeout handler as a periodic timer.
+     aedea_install_timeout_handler(animation_timer, &ani_rect, TMR_ID_ANIMATION_TIMER, TMR_INTERVAL_ANIMATION, AEDEA_TMR_PERIODIC);     
 
      // Start the AEDEA process manager.
      aedea_start();
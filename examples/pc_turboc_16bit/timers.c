@@ -80,9 +80,6 @@ void print_timer(uint8_t timer_id, void * arg_ptr)
      // This is done only to avoid any compiler warnings related to unused variables/arguments.
      (void)arg_ptr;
      
-     // Refresh the timer.
-     aedea_refresh_timer(timer_id, TMR_INTERVAL_PRINT);
-     
      // Log timer tick.
      log_entry.log_type = LOG_TIMER;
      log_entry.id = timer_id;
@@ -102,12 +99,12 @@ void animation_timer(uint8_t timer_id, void * arg_ptr)
      static bool_t inc_x = TRUE, inc_y = TRUE;
      rect_t * ani_rect_ptr;
      
+     // This is done only to avoid any compiler warnings related to unused variables/arguments.
+     (void)timer_id;
+     
      // Initialize the pointer to animation area rectangle.
      ani_rect_ptr = (rect_t * )arg_ptr;
      
-     // Refresh the timer.
-     aedea_refresh_timer(timer_id, TMR_INTERVAL_ANIMATION);
-     
      // Clear the animation area.
      scr_rect_clear(ani_rect_ptr);
      
@@ -52,11 +52,77 @@
 /*
  * ----- Header files -----
  */
-#include "..\port\platform.h"
-#include "..\port\options.h"
+#include "../port/platform.h"
+#include "../port/options.h"
 #include "aedea.h"
 
 
+/*
+ * ----- Option checks -----
+ */
+#if((AEDEA_OPT_USE_EVENT_TTL == 1) && (AEDEA_OPT_USE_SOFT_TMR == 0))
+#error "AEDEA_OPT_USE_EVENT_TTL requires AEDEA_OPT_USE_SOFT_TMR"
+#endif
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1) && \
+    (((PLATFORM_ARCH == 32) && ((AEDEA_OPT_TMR_WHEEL_BITS * AEDEA_OPT_TMR_WHEEL_LEVELS) >= 32)) || \
+     ((PLATFORM_ARCH != 32) && ((AEDEA_OPT_TMR_WHEEL_BITS * AEDEA_OPT_TMR_WHEEL_LEVELS) >= 16))))
+#error "AEDEA_OPT_TMR_WHEEL_BITS * AEDEA_OPT_TMR_WHEEL_LEVELS must be less than the width of port_uint_t"
+#endif
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1) && \
+    (!defined(PORT_TMR_ELAPSED) || !defined(PORT_TMR_SET_ONESHOT)))
+#error "AEDEA_OPT_TMR_TICKLESS requires PORT_TMR_ELAPSED() and PORT_TMR_SET_ONESHOT() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1) && \
+    ((PLATFORM_ARCH != 32) || !defined(PORT_CLOCK_NS)))
+#error "AEDEA_OPT_USE_CLOCK_NS requires a 32-bit platform and PORT_CLOCK_NS() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_HARD_TMRS == 1) && (AEDEA_OPT_TMR_DEFERRED_TICK == 1))
+#error "AEDEA_OPT_USE_HARD_TMRS cannot be used with AEDEA_OPT_TMR_DEFERRED_TICK"
+#endif
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1) && \
+    (0 != (AEDEA_OPT_TMR_CMD_QUEUE_SIZE & (AEDEA_OPT_TMR_CMD_QUEUE_SIZE - 1))))
+#error "AEDEA_OPT_TMR_CMD_QUEUE_SIZE must be a power of two"
+#endif
+
+#if((AEDEA_OPT_USE_CS_PROFILER == 1) && !defined(PORT_CYCLES))
+#error "AEDEA_OPT_USE_CS_PROFILER requires PORT_CYCLES() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_TRACE == 1) && !defined(PORT_CYCLES))
+#error "AEDEA_OPT_USE_TRACE requires PORT_CYCLES() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_TRACE == 1) && (0 != (AEDEA_OPT_TRACE_SIZE & (AEDEA_OPT_TRACE_SIZE - 1))))
+#error "AEDEA_OPT_TRACE_SIZE must be a power of two"
+#endif
+
+#if((AEDEA_OPT_USE_PROC_STATS == 1) && !defined(PORT_CYCLES))
+#error "AEDEA_OPT_USE_PROC_STATS requires PORT_CYCLES() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_SCHED_STATS == 1) && !defined(PORT_CYCLES))
+#error "AEDEA_OPT_USE_SCHED_STATS requires PORT_CYCLES() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_PROBES == 1) && (!defined(PORT_PROBE0) || !defined(PORT_PROBE1) || !defined(PORT_PROBE2)))
+#error "AEDEA_OPT_USE_PROBES requires PORT_PROBE0(), PORT_PROBE1() and PORT_PROBE2() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_FINE_LOCKS == 1) && \
+    (!defined(PORT_LOCK_INIT) || !defined(PORT_LOCK_TAKE) || !defined(PORT_LOCK_GIVE)))
+#error "AEDEA_OPT_USE_FINE_LOCKS requires port_lock_t, PORT_LOCK_INIT(), PORT_LOCK_TAKE() and PORT_LOCK_GIVE() in platform.h"
+#endif
+
+#if((AEDEA_OPT_USE_DELAYED_EVTS == 1) && (AEDEA_OPT_USE_SOFT_TMR == 0))
+#error "AEDEA_OPT_USE_DELAYED_EVTS requires AEDEA_OPT_USE_SOFT_TMR"
+#endif
+
+
 /*!
  * Queue structure.
  */
@@ -68,6 +134,31 @@ typedef struct
      port_uint_t count;                      //!< Number of unread items in the queue.
      port_uint_t head;                       //!< Head pointer for the queue.          
      port_uint_t tail;                       //!< Tail pointer for the queue.          
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     port_uint_t * stamp_ptr;                //!< Pointer to the stamp buffer (post tick of each item), NULL if no TTL is set.
+     port_uint_t ttl;                        //!< Maximum age of an item in ticks.
+     port_uint_t num_expired;                //!< Number of items discarded because their TTL expired.
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+     port_lock_t lock;                       //!< Lock protecting the queue.
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+#if((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1))
+     port_uint_t num_popped;                 //!< Number of items popped off the queue.
+#endif    /* ((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1)) */
+#if(AEDEA_OPT_USE_METRICS == 1)
+     port_uint_t num_dropped;                //!< Number of items which could not be pushed because the queue was full.
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     port_uint_t * lat_stamp_ptr;            //!< Pointer to the latency stamp buffer (PORT_CYCLES() when each item was pushed), NULL if the latency is not measured.
+     port_uint_t num_timed;                  //!< Number of popped items whose latency was measured.
+     unsigned long total_latency;            //!< Sum of the measured latencies.
+     port_uint_t max_latency;                //!< Longest measured latency.
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+#if(AEDEA_OPT_USE_TRACE == 1)
+     bool_t traced;                          //!< TRUE if pushes, pops and discards of items are traced (event queues).
+     uint8_t trace_id;                       //!< ID of the queue's trace records, the process ID.
+     port_uint_t trace_seq;                  //!< Sequence number of the next pushed item, the argument of its trace records.
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
 }                                            
 queue_t;
 
@@ -83,6 +174,12 @@ typedef struct
      port_int_t exec_delay;                  //!< Execution delay, the number of iterations of the process manager per process invocation.
      port_int_t iterations_to_exec;          //!< Stores the number of iterations until the next time the process is invoked.
      queue_t event_queue;                    //!< Process event queue.
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     port_uint_t invocations;                //!< Number of times the process callback was called.
+     port_uint_t empty_invocations;          //!< Number of calls in which the process did not pop any event.
+     unsigned long total_cycles;             //!< Time spent in the process callback.
+     port_uint_t max_cycles;                 //!< Longest process callback call.
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
 }
 proc_mgr_t;
 
@@ -91,23 +188,296 @@ proc_mgr_t;
  * Software timer structure.
  */
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
-typedef struct
+typedef struct sw_tmr_s
 {
      timeout_handler_t * handler;            //!< Pointer to the timeout handler function.
      void * handler_arg_ptr;                 //!< Pointer to the argument to be passed to the handler.
      uint8_t timer_id;                       //!< Timer ID.
-     port_uint_t num_ticks;                  //!< Number of ticks after which this timer should timeout.
+     uint8_t state;                          //!< Timer state (TMR_STATE_FREE, TMR_STATE_ARMED or TMR_STATE_EXPIRED).
+     bool_t pending;                         //!< TRUE if the timer has expired and its timeout handler has not been called yet.
+     bool_t queued;                          //!< TRUE while the timer's index is in the expired timers queue.
+     bool_t by_handle;                       //!< TRUE if the timer was installed with a handle, it is not looked up by its ID.
+#if(AEDEA_OPT_USE_HARD_TMRS == 1)
+     bool_t hard;                            //!< TRUE if the timeout handler is called from the timer tick.
+#endif    /* (AEDEA_OPT_USE_HARD_TMRS == 1) */
+     port_uint_t period;                     //!< Reload value in ticks for periodic timers, zero for one-shot timers.
+     port_uint_t gen;                        //!< Generation counter, incremented each time the timer is freed to invalidate handles.
+     port_uint_t num_ticks;                  //!< Delta list: number of ticks relative to the previous timer. Timing wheel: expiry tick.
+#if(AEDEA_OPT_USE_TMR_GROUPS == 1)
+     uint8_t group;                          //!< ID of the group the timer belongs to, AEDEA_TMR_NO_GROUP if none.
+     struct sw_tmr_s * grp_next_ptr;         //!< Next timer in the same group.
+     struct sw_tmr_s ** grp_prev_link_ptr;   //!< Pointer to the group link pointing at this timer, used for O(1) unlinking.
+#endif    /* (AEDEA_OPT_USE_TMR_GROUPS == 1) */
+#if(AEDEA_OPT_USE_TMR_EVENTS == 1)
+     uint8_t pid;                            //!< ID of the process the timer is bound to.
+     void * evt_item_ptr;                    //!< Event item posted to the process on expiry, NULL if the timer is not bound.
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     port_uint_t src;                        //!< Traffic matrix row of the process which bound the timer.
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+#endif    /* (AEDEA_OPT_USE_TMR_EVENTS == 1) */
+#if(AEDEA_OPT_USE_TMR_SLACK == 1)
+     port_uint_t slack;                      //!< Number of ticks the timer may expire late to be coalesced with other timers.
+     port_uint_t slack_delay;                //!< Number of ticks the current expiry was delayed by the slack.
+#endif    /* (AEDEA_OPT_USE_TMR_SLACK == 1) */
+#if(AEDEA_OPT_USE_CLOCK_NS == 1)
+     bool_t ns_mode;                         //!< TRUE if the timer was armed with a nanosecond timeout.
+     aedea_time_t deadline;                  //!< Nanosecond deadline of the timer (only valid if ns_mode is TRUE).
+     aedea_time_t period_ns;                 //!< Period in nanoseconds for periodic timers, zero for one-shot timers (only valid if ns_mode is TRUE).
+#endif    /* (AEDEA_OPT_USE_CLOCK_NS == 1) */
+#if(AEDEA_OPT_USE_TMR_LATENESS == 1)
+     port_uint_t due_tick;                   //!< Tick on which the pending expiry was due.
+     aedea_tmr_late_t late;                  //!< Lateness metrics of the timer.
+#endif    /* (AEDEA_OPT_USE_TMR_LATENESS == 1) */
+     struct sw_tmr_s * next_ptr;             //!< Next timer in the same list (delta list, wheel slot or free list).
+     struct sw_tmr_s ** prev_link_ptr;       //!< Pointer to the link pointing at this timer, used for O(1) unlinking.
 }
 sw_tmr_t;
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
+/*
+ * Software timer states.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define TMR_STATE_FREE        0    // Timer is on the free list.
+#define TMR_STATE_ARMED       1    // Timer is installed and running.
+#define TMR_STATE_EXPIRED     2    // Timer is installed but has expired (or was never re-armed).
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * Locks protecting an event queue and the timer table (timers, expired timers and delayed
+ * events). Without fine grained locks both are the global critical section. With them, the
+ * timer lock may be taken while holding the global critical section and a queue lock may
+ * be taken while holding the timer lock, never the other way round. The trace ring's lock
+ * is a leaf: it may be taken while holding any other lock and nothing is locked under it.
+ */
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+#define QUEUE_LOCK(queue_ptr)      PORT_LOCK_TAKE(&((queue_ptr)->lock))
+#define QUEUE_UNLOCK(queue_ptr)    PORT_LOCK_GIVE(&((queue_ptr)->lock))
+#define TMR_LOCK()                 tmr_lock_nesting(AEDEA_CRITICAL_SECTION_START)
+#define TMR_UNLOCK()               tmr_lock_nesting(AEDEA_CRITICAL_SECTION_END)
+#define TRACE_LOCK()               PORT_LOCK_TAKE(&trace_lock)
+#define TRACE_UNLOCK()             PORT_LOCK_GIVE(&trace_lock)
+#else
+#define QUEUE_LOCK(queue_ptr)      AEDEA_ENTER_CRITICAL_SECTION()
+#define QUEUE_UNLOCK(queue_ptr)    AEDEA_EXIT_CRITICAL_SECTION()
+#define TMR_LOCK()                 AEDEA_ENTER_CRITICAL_SECTION()
+#define TMR_UNLOCK()               AEDEA_EXIT_CRITICAL_SECTION()
+#define TRACE_LOCK()               AEDEA_ENTER_CRITICAL_SECTION()
+#define TRACE_UNLOCK()             AEDEA_EXIT_CRITICAL_SECTION()
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+
+
+/*
+ * Storage class of the critical section nesting level, ports which run AEDEA from several
+ * threads define it to make the nesting level thread local.
+ */
+#ifndef PORT_THREAD_LOCAL
+#define PORT_THREAD_LOCAL
+#endif    /* PORT_THREAD_LOCAL */
+
+
+/*!
+ * Timer command structure, an entry of the timer command queue.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+typedef struct
+{
+     volatile port_uint_t seq;               //!< Sequence number, tells whether the entry is free or holds a command for the current lap.
+     uint8_t op;                             //!< Command (TMR_CMD_INSTALL, TMR_CMD_REFRESH, TMR_CMD_DELETE, TMR_CMD_REARM or TMR_CMD_CANCEL).
+     uint8_t timer_id;                       //!< Timer ID for the timer ID based commands.
+     uint8_t flags;                          //!< Timer flags for TMR_CMD_INSTALL.
+     port_uint_t num_ticks;                  //!< Timeout for TMR_CMD_INSTALL, TMR_CMD_REFRESH and TMR_CMD_REARM.
+     timeout_handler_t * handler;            //!< Timeout handler for TMR_CMD_INSTALL.
+     void * handler_arg_ptr;                 //!< Handler argument for TMR_CMD_INSTALL.
+     aedea_tmr_handle_t handle;              //!< Timer handle for the handle based commands.
+}
+tmr_cmd_t;
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * Timer commands.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+#define TMR_CMD_INSTALL       0    // aedea_install_timeout_handler()
+#define TMR_CMD_REFRESH       1    // aedea_refresh_timer()
+#define TMR_CMD_DELETE        2    // aedea_delete_timer()
+#define TMR_CMD_REARM         3    // aedea_rearm_timer()
+#define TMR_CMD_CANCEL        4    // aedea_cancel_timer()
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * Static probe points (see AEDEA_OPT_USE_PROBES), not compiled in if the option is disabled.
+ */
+#if(AEDEA_OPT_USE_PROBES == 1)
+#define PROBE0(name)                  PORT_PROBE0(name)
+#define PROBE1(name, arg1)            PORT_PROBE1(name, arg1)
+#define PROBE2(name, arg1, arg2)      PORT_PROBE2(name, arg1, arg2)
+#else
+#define PROBE0(name)
+#define PROBE1(name, arg1)
+#define PROBE2(name, arg1, arg2)
+#endif    /* (AEDEA_OPT_USE_PROBES == 1) */
+
+
+/*
+ * Atomic operations used by the timer command queue, by default the submitters are assumed to
+ * run on a single core (threads or ISRs) and a compare-and-swap inside a critical section is
+ * used.
+ */
+#if(((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) || (AEDEA_OPT_USE_METRICS == 1))
+#ifndef PORT_ATOMIC_LOAD
+#define PORT_ATOMIC_LOAD(ptr)                        (*(ptr))
+#endif    /* PORT_ATOMIC_LOAD */
+
+#ifndef PORT_ATOMIC_STORE
+#define PORT_ATOMIC_STORE(ptr, value)                (*(ptr) = (value))
+#endif    /* PORT_ATOMIC_STORE */
+#endif    /* (((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) || (AEDEA_OPT_USE_METRICS == 1)) */
+
+#if(AEDEA_OPT_USE_METRICS == 1)
+#ifndef PORT_MEMORY_BARRIER
+#define PORT_MEMORY_BARRIER()
+#endif    /* PORT_MEMORY_BARRIER */
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+#ifndef PORT_ATOMIC_CAS
+#define PORT_ATOMIC_CAS(ptr, expected, desired)      tmr_cmd_cas((ptr), (expected), (desired))
+#define TMR_CMD_USE_CS_CAS
+#endif    /* PORT_ATOMIC_CAS */
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * Largest number of ticks a nanosecond timeout is armed with at once, longer timeouts are
+ * re-armed for the remainder when the timer fires.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+#define TMR_NS_MAX_TICKS      ((port_uint_t)~0 >> 1)
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*
+ * Timing wheel geometry.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+#define TMR_WHEEL_SLOTS       ((port_uint_t)1 << AEDEA_OPT_TMR_WHEEL_BITS)                                    // Number of slots per level.
+#define TMR_WHEEL_MASK        (TMR_WHEEL_SLOTS - 1)                                                           // Slot index mask.
+#define TMR_WHEEL_RANGE       ((port_uint_t)1 << (AEDEA_OPT_TMR_WHEEL_BITS * AEDEA_OPT_TMR_WHEEL_LEVELS))     // Number of ticks covered by the wheel.
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*!
+ * Delayed event structure.
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+typedef struct dly_evt_s
+{
+     struct dly_evt_s * next_ptr;                     //!< Next delayed event in the delta list (or the free list).
+     uint8_t pid;                                     //!< ID of the process the event is posted to.
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     port_uint_t src;                                 //!< Traffic matrix row of the process which queued the event.
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+     port_uint_t num_ticks;                           //!< Number of ticks relative to the previous delayed event in the delta list.
+     uint8_t evt_item[AEDEA_OPT_DELAYED_EVT_SIZE];    //!< Copy of the event item.
+}
+dly_evt_t;
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
+/*!
+ * Traffic matrix cell.
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+typedef struct
+{
+     port_uint_t count;                      //!< Number of events posted.
+     unsigned long bytes;                    //!< Number of bytes posted.
+}
+traffic_cell_t;
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * Traffic matrix dimensions, the matrix is indexed by the process manager indices of the
+ * source and destination, the last row counts posts from outside of a process callback.
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+#define TRAFFIC_SLOTS         (AEDEA_OPT_MAX_PROCESSES + 1)
+#define TRAFFIC_EXTERNAL      TRAFFIC_SLOTS
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*!
+ * Trace record structure. The layout is part of the trace dump format (see aedea_trace_dump()).
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+typedef struct
+{
+     port_uint_t time;                       //!< PORT_CYCLES() when the record was written.
+     port_uint_t arg;                        //!< Type specific argument.
+     uint8_t type;                           //!< Record type (AEDEA_TRACE_*).
+     uint8_t id;                             //!< Process or timer ID.
+}
+trace_rec_t;
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
+/*
+ * Trace dump format. The dump starts with the magic "AETR", the format version, the size of
+ * port_uint_t and of a record and a pad byte, followed by three port_uint_t: 1 (to detect the
+ * byte order), the number of records and the number of records lost to overwriting. The
+ * records follow, oldest first. Version 2 added the sequence numbers of POST and GET records
+ * and the DISCARD record.
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+#define TRACE_DUMP_VERSION    2
+#define TRACE_DUMP_HDR_SIZE   (8 + (3 * sizeof(port_uint_t)))
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
 /*
  * ----- File specific variables -----
  */
 static port_uint_t num_processes = 0;                       // Contains a count of the number of added processes.
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+static aedea_cs_prof_t cs_prof;                             // Critical section profile.
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+static trace_rec_t trace_ring[AEDEA_OPT_TRACE_SIZE];        // Trace ring.
+static port_uint_t trace_head = 0;                          // Index of the next record to be written (not wrapped).
+static port_uint_t trace_count = 0;                         // Number of valid records in the ring.
+static port_uint_t trace_lost = 0;                          // Number of records overwritten since the ring was cleared.
+static port_uint_t trace_mask = (port_uint_t)~0;            // Record types to be recorded.
+static PORT_THREAD_LOCAL uint8_t trace_quiet = 0;           // Non-zero while the trace recorder itself is in a critical section.
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+static port_lock_t trace_lock;                              // Lock protecting the trace ring.
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
 static proc_mgr_t * active_proc_mgr = NULL;                 // Contains the pointer to the currently active process manager.
 
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+static aedea_sched_stats_t sched_stats;                     // Published scheduler loop statistics.
+static aedea_sched_stats_t sched_window;                    // Scheduler loop statistics of the current window, only used by the scheduler.
+static port_uint_t sched_window_passes = 0;                 // Number of passes in the current window.
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+static traffic_cell_t traffic[TRAFFIC_SLOTS + 1][TRAFFIC_SLOTS];     // Traffic matrix, a column is protected by the lock of the destination's queue.
+static PORT_THREAD_LOCAL port_uint_t traffic_src = TRAFFIC_EXTERNAL; // Row of the process whose callback is running.
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+#if(AEDEA_OPT_USE_METRICS == 1)
+static volatile port_uint_t metrics_seq = 0;                // Sequence count of the metrics block, odd while the scheduler writes it.
+static aedea_metrics_t metrics;                             // Metrics block.
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
 #if(AEDEA_OPT_USE_SOFT_TMR == 0)
 static proc_mgr_t proc_mgrs[AEDEA_OPT_MAX_PROCESSES];       // Array of process managers for all added processes.
 #endif
@@ -118,13 +488,50 @@ static proc_mgr_t proc_mgrs[AEDEA_OPT_MAX_PROCESSES + 1];   // Array of process
 
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
 static port_uint_t num_timers = 0;                          // Contains a count of the number of installed timeout handlers.
-static sw_tmr_t sw_tmrs[AEDEA_OPT_MAX_SOFT_TMRS];           // Array of software timers for all installed timeout handlers.
-static port_uint_t active_tmrs_index = 0;                   // Contains the sw_tmrs index of the active software timer with lowest timeout value.
+static sw_tmr_t sw_tmrs[AEDEA_OPT_MAX_SOFT_TMRS];           // Pool of software timers for all installed timeout handlers.
+static sw_tmr_t * tmr_free_ptr = NULL;                      // Head of the list of free software timers.
 
-static sw_tmr_t exp_tmrs[AEDEA_OPT_MAX_SOFT_TMRS];          // Contains a list of all expired timers.
+static port_uint_t exp_tmrs[AEDEA_OPT_MAX_SOFT_TMRS];       // Contains the sw_tmrs indices of all expired timers.
 static queue_t exp_tmr_queue;                               // Queue for expired timers.
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+static port_lock_t tmr_lock;                                // Lock protecting the timer table.
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+
+static volatile port_uint_t tick_count = 0;                 // Number of timer ticks since initialization (wraps around).
+#if(AEDEA_OPT_TMR_DEFERRED_TICK == 1)
+static volatile port_uint_t pending_ticks = 0;              // Number of ticks counted by the tick ISR and not yet processed by the timer process.
+#endif    /* (AEDEA_OPT_TMR_DEFERRED_TICK == 1) */
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0))
+static sw_tmr_t * tmr_list_ptr = NULL;                      // Head of the delta list of running timers.
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static sw_tmr_t * tmr_wheel[AEDEA_OPT_TMR_WHEEL_LEVELS][TMR_WHEEL_SLOTS];    // Timing wheel slots, each slot is a list of running timers.
+static port_uint_t tmr_wheel_now = 0;                                       // Current tick of the timing wheel.
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+static tmr_cmd_t tmr_cmds[AEDEA_OPT_TMR_CMD_QUEUE_SIZE];     // Timer command queue entries.
+static volatile port_uint_t tmr_cmd_head = 0;                // Sequence number of the next entry to be claimed by a submitter.
+static port_uint_t tmr_cmd_tail = 0;                         // Sequence number of the next entry to be applied by the timer process.
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+static aedea_tmr_late_t tmr_late;                           // Lateness metrics of all timers.
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+static sw_tmr_t * tmr_groups[AEDEA_OPT_MAX_TMR_GROUPS];      // Heads of the lists of timers in each group.
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+static dly_evt_t dly_evts[AEDEA_OPT_MAX_DELAYED_EVTS];      // Pool of delayed events.
+static dly_evt_t * dly_evt_free_ptr = NULL;                 // Head of the list of free delayed events.
+static dly_evt_t * dly_evt_head_ptr = NULL;                 // Head of the delta list of pending delayed events.
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
 
 /*
  * ----- Local function prototypes -----
@@ -132,11 +539,106 @@ static queue_t exp_tmr_queue;                               // Queue for expired
 static bool_t queue_push_item(queue_t * queue_ptr,  const void * item_ptr);
 static bool_t queue_pop_item(queue_t * queue_ptr,  void * item_ptr);
 static void queue_copy_item(const void * src_ptr, void * dest_ptr, port_uint_t item_size);
+static proc_mgr_t * find_proc_mgr(uint8_t pid);
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+static void trace_record(uint8_t type, uint8_t id, port_uint_t arg);
+static void trace_write(uint8_t type, uint8_t id, port_uint_t arg);
+static void trace_write_cs(uint8_t type, port_uint_t arg);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+#if((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1))
+static port_uint_t proc_num_popped(proc_mgr_t * proc_mgr_ptr);
+#endif    /* ((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1)) */
+
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+static void proc_stats_clear(proc_mgr_t * proc_mgr_ptr);
+static void proc_stats_update(proc_mgr_t * proc_mgr_ptr, port_uint_t cycles, port_uint_t num_popped);
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+static void sched_stats_publish(void);
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+static port_uint_t traffic_source(void);
+static void traffic_record(proc_mgr_t * dst_proc_mgr_ptr, port_uint_t src);
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+#if((AEDEA_OPT_USE_TRAFFIC == 1) && ((AEDEA_OPT_USE_DELAYED_EVTS == 1) || (AEDEA_OPT_USE_TMR_EVENTS == 1)))
+static void traffic_post(uint8_t pid, void * evt_item_ptr, port_uint_t src);
+#endif    /* ((AEDEA_OPT_USE_TRAFFIC == 1) && ((AEDEA_OPT_USE_DELAYED_EVTS == 1) || (AEDEA_OPT_USE_TMR_EVENTS == 1))) */
+
+#if(AEDEA_OPT_USE_METRICS == 1)
+static void metrics_publish(void);
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
 
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
 static void timer_process(void * arg_ptr);
+static sw_tmr_t * tmr_find(uint8_t timer_id);
+static sw_tmr_t * tmr_alloc(timeout_handler_t * handler, void * handler_arg_ptr, uint8_t timer_id, port_uint_t num_ticks, uint8_t flags);
+static void tmr_free(sw_tmr_t * tmr_ptr);
+static sw_tmr_t * tmr_from_handle(aedea_tmr_handle_t handle);
+static void tmr_restart(sw_tmr_t * tmr_ptr, port_uint_t num_ticks);
+static void tmr_expire(sw_tmr_t * tmr_ptr);
+static void tmr_unlink(sw_tmr_t * tmr_ptr);
+static void tmr_link(sw_tmr_t ** link_ptr, sw_tmr_t * tmr_ptr);
+static void tmr_arm(sw_tmr_t * tmr_ptr, port_uint_t num_ticks);
+static void tmr_disarm(sw_tmr_t * tmr_ptr);
+static void tmr_tick(port_uint_t num_ticks);
+static port_uint_t tmr_next_expiry(void);
+static void tmr_advance(port_uint_t num_ticks);
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_FINE_LOCKS == 1))
+static void tmr_lock_nesting(uint8_t mode);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_FINE_LOCKS == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+static bool_t tmr_cmd_submit(tmr_cmd_t * cmd_ptr);
+static void tmr_cmd_apply(void);
+#ifdef TMR_CMD_USE_CS_CAS
+static bool_t tmr_cmd_cas(volatile port_uint_t * ptr, port_uint_t expected, port_uint_t desired);
+#endif    /* TMR_CMD_USE_CS_CAS */
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+static void tmr_late_clear(aedea_tmr_late_t * late_ptr);
+static void tmr_late_record(aedea_tmr_late_t * late_ptr, port_uint_t late);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+static void tmr_group_join(sw_tmr_t * tmr_ptr, uint8_t group);
+static void tmr_group_unlink(sw_tmr_t * tmr_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1))
+static port_uint_t tmr_apply_slack(sw_tmr_t * tmr_ptr, port_uint_t num_ticks);
+static port_uint_t tmr_remaining(sw_tmr_t * tmr_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+static aedea_time_t tmr_ns_deadline(aedea_time_t time_ns, uint8_t flags);
+static port_uint_t tmr_ns_to_ticks(aedea_time_t deadline);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1)))
+static void tmr_catch_up(void);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1))) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+static void tickless_program(void);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static void tmr_wheel_link(sw_tmr_t * tmr_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+static void dly_evt_tick(port_uint_t num_ticks);
+static port_uint_t dly_evt_next_expiry(void);
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
 
 /*
  * ----- Function: aedea_init() -----
@@ -144,17 +646,94 @@ static void timer_process(void * arg_ptr);
 void aedea_init(void)
 {
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
+     port_uint_t n = 0;
+
+     // Chain all software timers into the free list.
+     for(n = 0; n < AEDEA_OPT_MAX_SOFT_TMRS; n++)
+     {
+          sw_tmrs[n].state = TMR_STATE_FREE;
+          sw_tmrs[n].pending = FALSE;
+          sw_tmrs[n].queued = FALSE;
+          sw_tmrs[n].next_ptr = ((AEDEA_OPT_MAX_SOFT_TMRS - 1) == n) ? NULL : &(sw_tmrs[n + 1]);
+     }
+     tmr_free_ptr = &(sw_tmrs[0]);
+     num_timers = 0;
+
+#if(AEDEA_OPT_USE_TMR_WHEEL == 0)
+     tmr_list_ptr = NULL;
+#else
+     // Empty the timing wheel.
+     for(n = 0; n < (AEDEA_OPT_TMR_WHEEL_LEVELS * TMR_WHEEL_SLOTS); n++)
+     {
+          tmr_wheel[n / TMR_WHEEL_SLOTS][n % TMR_WHEEL_SLOTS] = NULL;
+     }
+     tmr_wheel_now = 0;
+#endif    /* (AEDEA_OPT_USE_TMR_WHEEL == 0) */
+
+#if(AEDEA_OPT_USE_TMR_GROUPS == 1)
+     for(n = 0; n < AEDEA_OPT_MAX_TMR_GROUPS; n++)
+     {
+          tmr_groups[n] = NULL;
+     }
+#endif    /* (AEDEA_OPT_USE_TMR_GROUPS == 1) */
+
+#if(AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)
+     // Entry n is free for the submitter which claims sequence number n.
+     for(n = 0; n < AEDEA_OPT_TMR_CMD_QUEUE_SIZE; n++)
+     {
+          tmr_cmds[n].seq = n;
+     }
+     tmr_cmd_head = 0;
+     tmr_cmd_tail = 0;
+#endif    /* (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1) */
+
      // Initialize the expired timers queue
      exp_tmr_queue.buff_ptr = exp_tmrs;
      exp_tmr_queue.num_items = AEDEA_OPT_MAX_SOFT_TMRS;
-     exp_tmr_queue.item_size = sizeof(sw_tmr_t);
+     exp_tmr_queue.item_size = sizeof(port_uint_t);
      exp_tmr_queue.count = 0;
      exp_tmr_queue.head = 0;
      exp_tmr_queue.tail = 0;
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     exp_tmr_queue.stamp_ptr = NULL;
+     exp_tmr_queue.ttl = 0;
+     exp_tmr_queue.num_expired = 0;
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+#if(AEDEA_OPT_USE_METRICS == 1)
+     exp_tmr_queue.num_dropped = 0;
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+     PORT_LOCK_INIT(&(exp_tmr_queue.lock));
+     PORT_LOCK_INIT(&tmr_lock);
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+#if((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1))
+     exp_tmr_queue.num_popped = 0;
+#endif    /* ((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1)) */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     exp_tmr_queue.lat_stamp_ptr = NULL;
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+#if(AEDEA_OPT_USE_TRACE == 1)
+     exp_tmr_queue.traced = FALSE;
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
      
      // Add the timer process.
      aedea_add_process(timer_process, NULL, PID_AEDEA_TIMER_PROCESS, NULL, 0, 0);
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+     // Chain all delayed events into the free list.
+     for(n = 0; n < (AEDEA_OPT_MAX_DELAYED_EVTS - 1); n++)
+     {
+          dly_evts[n].next_ptr = &(dly_evts[n + 1]);
+     }
+     dly_evts[AEDEA_OPT_MAX_DELAYED_EVTS - 1].next_ptr = NULL;
+     dly_evt_free_ptr = &(dly_evts[0]);
+     dly_evt_head_ptr = NULL;
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+#if((AEDEA_OPT_USE_TRACE == 1) && (AEDEA_OPT_USE_FINE_LOCKS == 1))
+     PORT_LOCK_INIT(&trace_lock);
+#endif    /* ((AEDEA_OPT_USE_TRACE == 1) && (AEDEA_OPT_USE_FINE_LOCKS == 1)) */
 }
 
 
@@ -164,6 +743,21 @@ void aedea_init(void)
 void aedea_start(void)
 {
      port_uint_t n = 0;
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     port_uint_t start_cycles;     // Cycle count when the process was called.
+     port_uint_t num_popped;       // Number of events popped off the process' queue before the call.
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+     port_uint_t pass_end;         // Cycle count at the end of the previous pass.
+     port_uint_t pass_cycles;      // Duration of the current pass.
+     port_uint_t sched_popped;     // Number of items popped by the process before the call.
+     unsigned long * pass_count_ptr;    // Counter of the current pass' kind.
+
+     pass_end = PORT_CYCLES();
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+#if(AEDEA_OPT_USE_METRICS == 1)
+     port_uint_t metrics_passes = 0;    // Number of passes since the metrics block was published.
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
 
      // Call all processes one by one.
      while(TRUE)
@@ -183,8 +777,50 @@ void aedea_start(void)
                // Reset the iteration count.
                active_proc_mgr->iterations_to_exec = active_proc_mgr->exec_delay;
           
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+               num_popped = proc_num_popped(active_proc_mgr);
+               start_cycles = PORT_CYCLES();
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+               sched_popped = proc_num_popped(active_proc_mgr);
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+               trace_record(AEDEA_TRACE_DISPATCH_START, active_proc_mgr->pid, 0);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+               PROBE1(dispatch_start, active_proc_mgr->pid);
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+               traffic_src = n;
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
                // Call process.
                active_proc_mgr->callback(active_proc_mgr->process_arg_ptr);
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+               traffic_src = TRAFFIC_EXTERNAL;
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+               PROBE1(dispatch_end, active_proc_mgr->pid);
+#if(AEDEA_OPT_USE_TRACE == 1)
+               trace_record(AEDEA_TRACE_DISPATCH_END, active_proc_mgr->pid, 0);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+               proc_stats_update(active_proc_mgr, PORT_CYCLES() - start_cycles, num_popped);
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+               if(sched_popped != proc_num_popped(active_proc_mgr))
+               {
+                    pass_count_ptr = &(sched_window.busy_calls);
+               }
+               else
+               {
+                    pass_count_ptr = &(sched_window.empty_calls);
+               }
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
           }
           else
           {
@@ -192,8 +828,48 @@ void aedea_start(void)
                if(AEDEA_PROCESS_DISABLED != active_proc_mgr->exec_delay)
                {
                    active_proc_mgr->iterations_to_exec--;
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+                   pass_count_ptr = &(sched_window.delayed_passes);
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+               }
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+               else
+               {
+                   pass_count_ptr = &(sched_window.disabled_passes);
                }
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+          }
+
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+          // Account the pass, only calls in which the process got work are busy time.
+          pass_cycles = PORT_CYCLES() - pass_end;
+          pass_end += pass_cycles;
+
+          (*pass_count_ptr)++;
+          if(&(sched_window.busy_calls) == pass_count_ptr)
+          {
+               sched_window.busy_cycles += pass_cycles;
+          }
+          else
+          {
+               sched_window.idle_cycles += pass_cycles;
+          }
+
+          sched_window_passes++;
+          if(AEDEA_OPT_SCHED_WINDOW == sched_window_passes)
+          {
+               sched_stats_publish();
+          }
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+#if(AEDEA_OPT_USE_METRICS == 1)
+          metrics_passes++;
+          if(AEDEA_OPT_METRICS_PERIOD == metrics_passes)
+          {
+               metrics_publish();
+               metrics_passes = 0;
           }
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
           
           // Increment loop counter.
           n = (n + 1) % num_processes;
@@ -233,6 +909,29 @@ bool_t aedea_add_process(
      proc_mgrs[num_processes].event_queue.count = 0;
      proc_mgrs[num_processes].event_queue.head = 0;
      proc_mgrs[num_processes].event_queue.tail = 0;
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     proc_mgrs[num_processes].event_queue.stamp_ptr = NULL;
+     proc_mgrs[num_processes].event_queue.ttl = 0;
+     proc_mgrs[num_processes].event_queue.num_expired = 0;
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+#if(AEDEA_OPT_USE_METRICS == 1)
+     proc_mgrs[num_processes].event_queue.num_dropped = 0;
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+     PORT_LOCK_INIT(&(proc_mgrs[num_processes].event_queue.lock));
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+#if((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1))
+     proc_mgrs[num_processes].event_queue.num_popped = 0;
+#endif    /* ((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1)) */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     proc_mgrs[num_processes].event_queue.lat_stamp_ptr = NULL;
+     proc_stats_clear(&(proc_mgrs[num_processes]));
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+#if(AEDEA_OPT_USE_TRACE == 1)
+     proc_mgrs[num_processes].event_queue.traced = TRUE;
+     proc_mgrs[num_processes].event_queue.trace_id = pid;
+     proc_mgrs[num_processes].event_queue.trace_seq = 0;
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
      
      // Increment the number of added processes.
      num_processes++;
@@ -281,17 +980,89 @@ bool_t aedea_set_exec_delay(uint8_t pid, port_int_t exec_delay)
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
 static void timer_process(void * arg_ptr)
 {
-     sw_tmr_t expired_tmr;    // Stores an expired software timer popped from the expired timers queue.
+     port_uint_t index;                 // Stores the index of an expired software timer popped from the expired timers queue.
+     sw_tmr_t * tmr_ptr;                // The expired software timer.
+     timeout_handler_t * handler;       // Copy of the expired timer's timeout handler, NULL if it must not be called.
+     void * handler_arg_ptr;            // Copy of the expired timer's handler argument.
+     uint8_t timer_id;                  // Copy of the expired timer's ID.
+#if(AEDEA_OPT_USE_TMR_LATENESS == 1)
+     port_uint_t late;                  // Number of ticks the handler is called after the expiry.
+#endif    /* (AEDEA_OPT_USE_TMR_LATENESS == 1) */
      
      // This is done only to avoid any compiler warnings related to unused variables/arguments.
      (void)arg_ptr;
+
+#if(AEDEA_OPT_TMR_DEFERRED_TICK == 1)
+     // Do the expiry work for the ticks counted by the tick ISR.
+     TMR_LOCK();
+
+     if(0 != pending_ticks)
+     {
+          tmr_catch_up();
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+          tickless_program();
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+     }
+
+     TMR_UNLOCK();
+#endif    /* (AEDEA_OPT_TMR_DEFERRED_TICK == 1) */
+
+#if(AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)
+     // Apply the submitted timer commands.
+     tmr_cmd_apply();
+#endif    /* (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1) */
      
      // Pop expired timers from the expired timers queue and call the timeout
      // handlers one by one.
-     while(TRUE == queue_pop_item(&exp_tmr_queue, &expired_tmr))
+     while(TRUE)
      {
-          // Call the expired_tmr timer's timeout handler.
-          expired_tmr.handler(expired_tmr.timer_id, expired_tmr.handler_arg_ptr);
+          TMR_LOCK();
+
+#if((AEDEA_OPT_USE_TMR_LATENESS == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+          // The tick count is only brought up to date when the one-shot timer fires, credit
+          // the elapsed ticks before the lateness of the next handler call is measured.
+          tmr_catch_up();
+          tickless_program();
+#endif    /* ((AEDEA_OPT_USE_TMR_LATENESS == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+          if(FALSE == queue_pop_item(&exp_tmr_queue, &index))
+          {
+               TMR_UNLOCK();
+               break;
+          }
+
+          // Timers which were deleted or re-armed after they expired are no longer
+          // pending, their handlers are skipped.
+          tmr_ptr = &(sw_tmrs[index]);
+          tmr_ptr->queued = FALSE;
+          handler = NULL;
+
+          if(TRUE == tmr_ptr->pending)
+          {
+               tmr_ptr->pending = FALSE;
+               handler = tmr_ptr->handler;
+               handler_arg_ptr = tmr_ptr->handler_arg_ptr;
+               timer_id = tmr_ptr->timer_id;
+
+#if(AEDEA_OPT_USE_TMR_LATENESS == 1)
+               // Ticks still to be credited by the timer process have already passed.
+#if((AEDEA_OPT_TMR_DEFERRED_TICK == 1) && (AEDEA_OPT_TMR_TICKLESS == 0))
+               late = (tick_count + pending_ticks) - tmr_ptr->due_tick;
+#else
+               late = tick_count - tmr_ptr->due_tick;
+#endif    /* ((AEDEA_OPT_TMR_DEFERRED_TICK == 1) && (AEDEA_OPT_TMR_TICKLESS == 0)) */
+               tmr_late_record(&(tmr_ptr->late), late);
+               tmr_late_record(&tmr_late, late);
+#endif    /* (AEDEA_OPT_USE_TMR_LATENESS == 1) */
+          }
+
+          TMR_UNLOCK();
+
+          // Call the expired timer's timeout handler.
+          if(NULL != handler)
+          {
+               handler(timer_id, handler_arg_ptr);
+          }
      }
 }
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
@@ -303,316 +1074,2675 @@ static void timer_process(void * arg_ptr)
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
 void aedea_timer_tick(void)
 {
-     port_uint_t n = 0;
+#if(AEDEA_OPT_TMR_DEFERRED_TICK == 1)
+     // Only count the tick, the timer process does the expiry work.
+     TMR_LOCK();
 
-     // If all timers have expired, return
-     if(AEDEA_OPT_MAX_SOFT_TMRS == active_tmrs_index)
-     {
-          return;
-     }
+     pending_ticks++;
 
-     // Decrement the top timer's number of ticks
-     sw_tmrs[active_tmrs_index].num_ticks--;
+     TMR_UNLOCK();
+#elif(AEDEA_OPT_TMR_TICKLESS == 0)
+     // Advance the timers by one tick.
+     TMR_LOCK();
 
-     // Check to see if decrementing the top timer's number of ticks above caused
-     // it to expire. If that was the case, add this timer and any below it with
-     // a timeout value of zero to the expired timers list and increment the
-     // active_tmrs_index variable.
-     for(n = active_tmrs_index; n < num_timers; n++)
-     {
-          // If the number of ticks are zero, add the timer to the expired
-          // timers list and increment active_tmrs_index.
-          if(0 == sw_tmrs[n].num_ticks)
-          {
-               active_tmrs_index++;
-               queue_push_item(&exp_tmr_queue, &sw_tmrs[n]);
-          }
-          // The timer hasn't expired, break out of the loop.
-          else
-          {
-               break;
-          }
-     }
+     tmr_advance(1);
+
+     TMR_UNLOCK();
+#else
+     // The one-shot deadline was reached (or the ISR fired early), credit all
+     // ticks elapsed since the last update in one step and program the next
+     // deadline.
+     TMR_LOCK();
+
+     tmr_catch_up();
+     tickless_program();
+
+     TMR_UNLOCK();
+#endif    /* (AEDEA_OPT_TMR_DEFERRED_TICK == 1) */
 }
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
 /*
- * ----- Function: aedea_add_periodic_process() -----
+ * ----- Function: aedea_timer_advance() -----
  */
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
-bool_t aedea_install_timeout_handler(
-                                     timeout_handler_t * handler,
-                                     void * handler_arg_ptr,
-                                     uint8_t timer_id,
-                                     port_uint_t num_ticks
-                                    )
+void aedea_timer_advance(port_uint_t num_ticks)
 {
-     port_int_t n = 0;
-     port_uint_t sum_ticks = 0;
-     port_uint_t insert_index = 0;
-     
-     // Return FALSE if the sw_tmrs array is full.
-     if(AEDEA_OPT_MAX_SOFT_TMRS == num_timers)
-     {
-          return FALSE;
-     }
-     
-     AEDEA_ENTER_CRITICAL_SECTION();
+     TMR_LOCK();
+
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+     // The port's clock counts the elapsed ticks, credit all of them as the one-shot
+     // timer's ISR would.
+     (void)num_ticks;
+     tmr_catch_up();
+     tickless_program();
+#elif(AEDEA_OPT_TMR_DEFERRED_TICK == 1)
+     // The ticks are credited by the timer process.
+     pending_ticks += num_ticks;
+#else
+     tmr_advance(num_ticks);
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+
+     TMR_UNLOCK();
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
-     // If there are no timeout handlers installed yet, just add the timeout handler
-     // to the top of the sw_tmrs array.
-     if(0 == num_timers)
-     {
-          insert_index = 0;
-     }
-     // There are active timers already present, search the sw_tmrs array
-     // for a suitable location for the new timer.
-     else
-     {
-          // A cumulative sum of the number of ticks for each active timer is calculated
-          // in sum_ticks at each iteration (n) of the following loop, which is then compared
-          // with the timeout value for the new timer. If, at any point, the timeout value
-          // for the new timer is less than the cumulatvie sum sum_ticks, the new timer is
-          // inserted at n - 1. If at the end of the loop, the cumulative sum was not greater
-          // than the timeout value for the new timer, the new timer is inserted at n + 1.
-          for(n = active_tmrs_index; n < (port_int_t)num_timers; n++)
-          {
-               sum_ticks += sw_tmrs[n].num_ticks;
 
-               if(sum_ticks > num_ticks)
-               {
-                    insert_index = n;
-                    break;
-               }
-               else if(n == (port_int_t)(num_timers - 1))
-               {
-                    insert_index = n + 1;
-                    break;
-               }
-          }
-     }
-     
-     // If required, shift all timers downwards one index. 
-     for(n = (num_timers - 1); n >= (port_int_t)insert_index; n--)
-     {
-          sw_tmrs[n + 1].handler = sw_tmrs[n].handler;
-          sw_tmrs[n + 1].handler_arg_ptr = sw_tmrs[n].handler_arg_ptr;
-          sw_tmrs[n + 1].timer_id = sw_tmrs[n].timer_id;
-          sw_tmrs[n + 1].num_ticks = sw_tmrs[n].num_ticks;
-     }
+/*
+ * ----- Function: aedea_next_expiry() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+port_uint_t aedea_next_expiry(void)
+{
+     port_uint_t num_ticks;        // Number of ticks until the next timer expires.
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+     port_uint_t dly_num_ticks;    // Number of ticks until the next delayed event is due.
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
 
-     // Insert the new timer.
-     sw_tmrs[insert_index].handler = handler;
-     sw_tmrs[insert_index].handler_arg_ptr = handler_arg_ptr;
-     sw_tmrs[insert_index].timer_id = timer_id;
-     
-     // Increment the number of installed timers.
-     num_timers++;
-     
-     // Adjust the timeout value for the new timer by calculating the cumulative
-     // sum of all timers before this one and subtracting it from the specified
-     // timeout value for it.
-     sum_ticks = 0;
-     for(n = active_tmrs_index; n < (char)insert_index; n++)
-     {
-          sum_ticks += sw_tmrs[n].num_ticks;
-     }
-     
-     sw_tmrs[insert_index].num_ticks = num_ticks - sum_ticks;
+     TMR_LOCK();
 
-     // Adjust the timeout value for the timer present immediatetely below the
-     // new timer (if any).
-     if((insert_index + 1) < num_timers)
-     {
-          sw_tmrs[insert_index + 1].num_ticks -= sw_tmrs[insert_index].num_ticks;
-     }
-     
-     // Reset active_tmrs_index if insert_index is zero. This handles a corner case
-     // when all timers have expired.
-     if(insert_index == 0)
+     num_ticks = tmr_next_expiry();
+
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+     dly_num_ticks = dly_evt_next_expiry();
+     if(dly_num_ticks < num_ticks)
      {
-          active_tmrs_index = 0;
+          num_ticks = dly_num_ticks;
      }
-     
-     AEDEA_EXIT_CRITICAL_SECTION();
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
 
-     return TRUE;
+     TMR_UNLOCK();
+
+     return num_ticks;
 }
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
 /*
- * ----- Function; aedea_refresh_timer() -----
+ * ----- Function: tmr_advance() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static void tmr_advance(port_uint_t num_ticks)
+{
+     port_uint_t step;        // Number of ticks processed in one go.
+
+     // Nothing can expire before the next timer or delayed event is due, the ticks up
+     // to it are skipped in one step. The work done is proportional to the number of
+     // expiries, not to the number of elapsed ticks. Looking ahead scans the timing
+     // wheel, so it is only done if more than one tick is left.
+     while(0 != num_ticks)
+     {
+          step = 1;
+          if(1 != num_ticks)
+          {
+               step = aedea_next_expiry();
+               if(0 == step)
+               {
+                    step = 1;
+               }
+               if(num_ticks < step)
+               {
+                    step = num_ticks;
+               }
+          }
+
+          // Advance the tick count.
+          tick_count += step;
+
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+          // Post delayed events which are due.
+          dly_evt_tick(step);
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+          // Advance the software timers.
+          tmr_tick(step);
+
+          num_ticks -= step;
+     }
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_catch_up() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1)))
+static void tmr_catch_up(void)
+{
+#if(AEDEA_OPT_TMR_TICKLESS == 0)
+     port_uint_t num_ticks;   // Number of ticks counted by the tick ISR.
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 0) */
+
+     // Credit the ticks which have elapsed but were not processed yet, this has to be
+     // done before any timeout relative to the current tick is used.
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+#if(AEDEA_OPT_TMR_DEFERRED_TICK == 1)
+     // The port reports the elapsed ticks, the deferred tick counter only tells that
+     // the one-shot timer has fired.
+     pending_ticks = 0;
+#endif    /* (AEDEA_OPT_TMR_DEFERRED_TICK == 1) */
+     tmr_advance(PORT_TMR_ELAPSED());
+#else
+     num_ticks = pending_ticks;
+     pending_ticks = 0;
+     tmr_advance(num_ticks);
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1))) */
+
+
+/*
+ * ----- Function: tickless_program() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+static void tickless_program(void)
+{
+     // Program the one-shot timer for the earliest deadline, AEDEA_TMR_NO_EXPIRY
+     // tells the port that no deadline is pending.
+     PORT_TMR_SET_ONESHOT(aedea_next_expiry());
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * ----- Function: aedea_install_timeout_handler() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_install_timeout_handler(
+                                     timeout_handler_t * handler,
+                                     void * handler_arg_ptr,
+                                     uint8_t timer_id,
+                                     port_uint_t num_ticks,
+                                     uint8_t flags
+                                    )
+{
+     sw_tmr_t * tmr_ptr;      // The software timer allocated for the new timeout handler.
+
+     TMR_LOCK();
+
+     tmr_ptr = tmr_alloc(handler, handler_arg_ptr, timer_id, num_ticks, flags);
+
+     TMR_UNLOCK();
+
+     return (NULL != tmr_ptr) ? TRUE : FALSE;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function; aedea_refresh_timer() -----
  */
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
 bool_t aedea_refresh_timer(uint8_t timer_id, port_uint_t num_ticks)
 {
-     port_uint_t n = 0;
-     timeout_handler_t * handler;       // Used to store the pointer to timeout handler function of the specified timer.
-     void * handler_arg_ptr;            // Used to store the argument pointer of the specified timer.
-     
-     // Return FALSE if no timers have been installed.
-     if(0 == num_timers)
+     sw_tmr_t * tmr_ptr;      // The software timer with the specified timer ID.
+
+     TMR_LOCK();
+
+     // Search for the timer with the specified timer ID, return FALSE if no timer was found.
+     tmr_ptr = tmr_find(timer_id);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     // Re-arm the timer with the new timeout value.
+     tmr_restart(tmr_ptr, num_ticks);
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function; aedea_delete_timer() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_delete_timer(uint8_t timer_id)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer with the specified timer ID.
+
+     TMR_LOCK();
+
+     // Search for the timer with the specified timer ID, return FALSE if no timer was found.
+     tmr_ptr = tmr_find(timer_id);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     tmr_free(tmr_ptr);
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: aedea_install_timer() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_install_timer(
+                           aedea_tmr_handle_t * handle_ptr,
+                           timeout_handler_t * handler,
+                           void * handler_arg_ptr,
+                           uint8_t timer_id,
+                           port_uint_t num_ticks,
+                           uint8_t flags
+                          )
+{
+     sw_tmr_t * tmr_ptr;      // The software timer allocated for the new timeout handler.
+
+     TMR_LOCK();
+
+     tmr_ptr = tmr_alloc(handler, handler_arg_ptr, timer_id, num_ticks, flags);
+     if(NULL != tmr_ptr)
+     {
+          tmr_ptr->by_handle = TRUE;
+
+          // The handle identifies the pool slot and the slot's current generation.
+          handle_ptr->slot = (port_uint_t)(tmr_ptr - sw_tmrs);
+          handle_ptr->gen = tmr_ptr->gen;
+     }
+
+     TMR_UNLOCK();
+
+     return (NULL != tmr_ptr) ? TRUE : FALSE;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: aedea_rearm_timer() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_rearm_timer(aedea_tmr_handle_t handle, port_uint_t num_ticks)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer the handle refers to.
+
+     TMR_LOCK();
+
+     // Return FALSE if the handle is stale.
+     tmr_ptr = tmr_from_handle(handle);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     // Re-arm the timer with the new timeout value.
+     tmr_restart(tmr_ptr, num_ticks);
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: aedea_cancel_timer() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_cancel_timer(aedea_tmr_handle_t handle)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer the handle refers to.
+
+     TMR_LOCK();
+
+     // Return FALSE if the handle is stale.
+     tmr_ptr = tmr_from_handle(handle);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     tmr_free(tmr_ptr);
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: aedea_submit_install() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_install(
+                            timeout_handler_t * handler,
+                            void * handler_arg_ptr,
+                            uint8_t timer_id,
+                            port_uint_t num_ticks,
+                            uint8_t flags
+                           )
+{
+     tmr_cmd_t cmd = {0};     // The command, fields it does not use are zero.
+
+#if(AEDEA_OPT_USE_HARD_TMRS == 0)
+     // Reject a hard timer here, the install itself fails silently in the timer process.
+     if(0 != (flags & AEDEA_TMR_HARD))
+     {
+          return FALSE;
+     }
+#endif    /* (AEDEA_OPT_USE_HARD_TMRS == 0) */
+
+     cmd.op = TMR_CMD_INSTALL;
+     cmd.handler = handler;
+     cmd.handler_arg_ptr = handler_arg_ptr;
+     cmd.timer_id = timer_id;
+     cmd.num_ticks = num_ticks;
+     cmd.flags = flags;
+
+     return tmr_cmd_submit(&cmd);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: aedea_submit_refresh() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_refresh(uint8_t timer_id, port_uint_t num_ticks)
+{
+     tmr_cmd_t cmd = {0};     // The command, fields it does not use are zero.
+
+     cmd.op = TMR_CMD_REFRESH;
+     cmd.timer_id = timer_id;
+     cmd.num_ticks = num_ticks;
+
+     return tmr_cmd_submit(&cmd);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: aedea_submit_delete() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_delete(uint8_t timer_id)
+{
+     tmr_cmd_t cmd = {0};     // The command, fields it does not use are zero.
+
+     cmd.op = TMR_CMD_DELETE;
+     cmd.timer_id = timer_id;
+
+     return tmr_cmd_submit(&cmd);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: aedea_submit_rearm() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_rearm(aedea_tmr_handle_t handle, port_uint_t num_ticks)
+{
+     tmr_cmd_t cmd = {0};     // The command, fields it does not use are zero.
+
+     cmd.op = TMR_CMD_REARM;
+     cmd.handle = handle;
+     cmd.num_ticks = num_ticks;
+
+     return tmr_cmd_submit(&cmd);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: aedea_submit_cancel() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_cancel(aedea_tmr_handle_t handle)
+{
+     tmr_cmd_t cmd = {0};     // The command, fields it does not use are zero.
+
+     cmd.op = TMR_CMD_CANCEL;
+     cmd.handle = handle;
+
+     return tmr_cmd_submit(&cmd);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: tmr_cmd_submit() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+static bool_t tmr_cmd_submit(tmr_cmd_t * cmd_ptr)
+{
+     tmr_cmd_t * entry_ptr;   // Entry claimed for the command.
+     port_uint_t pos;         // Sequence number of the entry.
+     port_int_t diff;         // Difference between the entry's sequence number and pos.
+
+     // Claim the next entry. An entry whose sequence number equals pos is free for
+     // this lap, one that lags behind still holds a command from the previous lap
+     // (the queue is full). Losing the race to another submitter just retries with
+     // the next position.
+     pos = PORT_ATOMIC_LOAD(&tmr_cmd_head);
+     while(TRUE)
+     {
+          entry_ptr = &(tmr_cmds[pos & (AEDEA_OPT_TMR_CMD_QUEUE_SIZE - 1)]);
+          diff = (port_int_t)(PORT_ATOMIC_LOAD(&(entry_ptr->seq)) - pos);
+
+          if(0 == diff)
+          {
+               if(TRUE == PORT_ATOMIC_CAS(&tmr_cmd_head, pos, pos + 1))
+               {
+                    break;
+               }
+          }
+          else if(0 > diff)
+          {
+               return FALSE;
+          }
+
+          pos = PORT_ATOMIC_LOAD(&tmr_cmd_head);
+     }
+
+     // Fill in the entry and publish it to the timer process.
+     entry_ptr->op = cmd_ptr->op;
+     entry_ptr->timer_id = cmd_ptr->timer_id;
+     entry_ptr->flags = cmd_ptr->flags;
+     entry_ptr->num_ticks = cmd_ptr->num_ticks;
+     entry_ptr->handler = cmd_ptr->handler;
+     entry_ptr->handler_arg_ptr = cmd_ptr->handler_arg_ptr;
+     entry_ptr->handle = cmd_ptr->handle;
+
+     PORT_ATOMIC_STORE(&(entry_ptr->seq), pos + 1);
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: tmr_cmd_apply() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+static void tmr_cmd_apply(void)
+{
+     tmr_cmd_t * entry_ptr;   // Entry holding the next command.
+
+     // Apply published commands in order, stop at the first entry which has been
+     // claimed but not yet filled in.
+     while(TRUE)
+     {
+          entry_ptr = &(tmr_cmds[tmr_cmd_tail & (AEDEA_OPT_TMR_CMD_QUEUE_SIZE - 1)]);
+          if((tmr_cmd_tail + 1) != PORT_ATOMIC_LOAD(&(entry_ptr->seq)))
+          {
+               break;
+          }
+
+          switch(entry_ptr->op)
+          {
+               case TMR_CMD_INSTALL:
+                    (void)aedea_install_timeout_handler(entry_ptr->handler, entry_ptr->handler_arg_ptr, entry_ptr->timer_id, entry_ptr->num_ticks, entry_ptr->flags);
+                    break;
+
+               case TMR_CMD_REFRESH:
+                    (void)aedea_refresh_timer(entry_ptr->timer_id, entry_ptr->num_ticks);
+                    break;
+
+               case TMR_CMD_DELETE:
+                    (void)aedea_delete_timer(entry_ptr->timer_id);
+                    break;
+
+               case TMR_CMD_REARM:
+                    (void)aedea_rearm_timer(entry_ptr->handle, entry_ptr->num_ticks);
+                    break;
+
+               case TMR_CMD_CANCEL:
+                    (void)aedea_cancel_timer(entry_ptr->handle);
+                    break;
+
+               default:
+                    break;
+          }
+
+          // Hand the entry back to the submitters for the next lap.
+          PORT_ATOMIC_STORE(&(entry_ptr->seq), tmr_cmd_tail + AEDEA_OPT_TMR_CMD_QUEUE_SIZE);
+          tmr_cmd_tail++;
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*
+ * ----- Function: tmr_cmd_cas() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1) && defined(TMR_CMD_USE_CS_CAS))
+static bool_t tmr_cmd_cas(volatile port_uint_t * ptr, port_uint_t expected, port_uint_t desired)
+{
+     bool_t swapped = FALSE;
+
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     if(expected == *ptr)
+     {
+          *ptr = desired;
+          swapped = TRUE;
+     }
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+
+     return swapped;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1) && defined(TMR_CMD_USE_CS_CAS)) */
+
+
+/*
+ * ----- Function: aedea_get_timer_lateness() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+bool_t aedea_get_timer_lateness(uint8_t timer_id, aedea_tmr_late_t * late_ptr)
+{
+     sw_tmr_t * tmr_ptr;
+
+     TMR_LOCK();
+
+     tmr_ptr = tmr_find(timer_id);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     *late_ptr = tmr_ptr->late;
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*
+ * ----- Function: aedea_get_global_lateness() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+void aedea_get_global_lateness(aedea_tmr_late_t * late_ptr)
+{
+     TMR_LOCK();
+
+     *late_ptr = tmr_late;
+
+     TMR_UNLOCK();
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*
+ * ----- Function: aedea_reset_lateness() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+void aedea_reset_lateness(void)
+{
+     port_uint_t n;
+
+     TMR_LOCK();
+
+     for(n = 0; n < AEDEA_OPT_MAX_SOFT_TMRS; n++)
+     {
+          tmr_late_clear(&(sw_tmrs[n].late));
+     }
+     tmr_late_clear(&tmr_late);
+
+     TMR_UNLOCK();
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*
+ * ----- Function: tmr_late_clear() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+static void tmr_late_clear(aedea_tmr_late_t * late_ptr)
+{
+     port_uint_t n;
+
+     late_ptr->count = 0;
+     late_ptr->max = 0;
+     late_ptr->total = 0;
+     late_ptr->missed = 0;
+     for(n = 0; n < AEDEA_OPT_TMR_LATE_BUCKETS; n++)
+     {
+          late_ptr->hist[n] = 0;
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*
+ * ----- Function: tmr_late_record() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+static void tmr_late_record(aedea_tmr_late_t * late_ptr, port_uint_t late)
+{
+     port_uint_t n;
+
+     late_ptr->count++;
+     late_ptr->total += late;
+     if(late > late_ptr->max)
+     {
+          late_ptr->max = late;
+     }
+
+     // Bucket n holds lateness values of n significant bits.
+     for(n = 0; (n < (AEDEA_OPT_TMR_LATE_BUCKETS - 1)) && (0 != late); n++)
+     {
+          late >>= 1;
+     }
+     late_ptr->hist[n]++;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*
+ * ----- Function: aedea_set_timer_group() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+bool_t aedea_set_timer_group(aedea_tmr_handle_t handle, uint8_t group)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer the handle refers to.
+
+     TMR_LOCK();
+
+     // Return FALSE if the handle is stale or the group ID is invalid.
+     tmr_ptr = tmr_from_handle(handle);
+     if((NULL == tmr_ptr) || ((AEDEA_TMR_NO_GROUP != group) && (AEDEA_OPT_MAX_TMR_GROUPS <= group)))
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     tmr_group_join(tmr_ptr, group);
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*
+ * ----- Function: aedea_set_timer_group_by_id() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+bool_t aedea_set_timer_group_by_id(uint8_t timer_id, uint8_t group)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer with the specified timer ID.
+
+     TMR_LOCK();
+
+     // Return FALSE if no timer with the specified ID is installed or the group ID is invalid.
+     tmr_ptr = tmr_find(timer_id);
+     if((NULL == tmr_ptr) || ((AEDEA_TMR_NO_GROUP != group) && (AEDEA_OPT_MAX_TMR_GROUPS <= group)))
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     tmr_group_join(tmr_ptr, group);
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*
+ * ----- Function: aedea_cancel_group() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+port_uint_t aedea_cancel_group(uint8_t group)
+{
+     port_uint_t num_cancelled = 0;
+
+     // Return if the group ID is invalid.
+     if(AEDEA_OPT_MAX_TMR_GROUPS <= group)
+     {
+          return 0;
+     }
+
+     TMR_LOCK();
+
+     // Freeing a timer unlinks it from the group, so release the group's first timer
+     // until the group is empty. Queued expiries of the released timers are no longer
+     // pending and are skipped by the timer process.
+     while(NULL != tmr_groups[group])
+     {
+          tmr_free(tmr_groups[group]);
+          num_cancelled++;
+     }
+
+     TMR_UNLOCK();
+
+     return num_cancelled;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*
+ * ----- Function: tmr_group_join() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+static void tmr_group_join(sw_tmr_t * tmr_ptr, uint8_t group)
+{
+     // Leave the current group and push the timer on to the new group's list.
+     tmr_group_unlink(tmr_ptr);
+
+     tmr_ptr->group = group;
+     if(AEDEA_TMR_NO_GROUP != group)
+     {
+          tmr_ptr->grp_next_ptr = tmr_groups[group];
+          tmr_ptr->grp_prev_link_ptr = &(tmr_groups[group]);
+
+          if(NULL != tmr_ptr->grp_next_ptr)
+          {
+               tmr_ptr->grp_next_ptr->grp_prev_link_ptr = &(tmr_ptr->grp_next_ptr);
+          }
+          tmr_groups[group] = tmr_ptr;
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*
+ * ----- Function: tmr_group_unlink() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+static void tmr_group_unlink(sw_tmr_t * tmr_ptr)
+{
+     // Return if the timer is not in a group.
+     if(AEDEA_TMR_NO_GROUP == tmr_ptr->group)
+     {
+          return;
+     }
+
+     *(tmr_ptr->grp_prev_link_ptr) = tmr_ptr->grp_next_ptr;
+     if(NULL != tmr_ptr->grp_next_ptr)
+     {
+          tmr_ptr->grp_next_ptr->grp_prev_link_ptr = tmr_ptr->grp_prev_link_ptr;
+     }
+
+     tmr_ptr->group = AEDEA_TMR_NO_GROUP;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*
+ * ----- Function: aedea_bind_timer() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_EVENTS == 1))
+bool_t aedea_bind_timer(aedea_tmr_handle_t handle, uint8_t pid, void * evt_item_ptr)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer the handle refers to.
+
+     TMR_LOCK();
+
+     // Return FALSE if the handle is stale or the process does not exist.
+     tmr_ptr = tmr_from_handle(handle);
+     if((NULL == tmr_ptr) || ((NULL != evt_item_ptr) && (NULL == find_proc_mgr(pid))))
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     tmr_ptr->pid = pid;
+     tmr_ptr->evt_item_ptr = evt_item_ptr;
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     tmr_ptr->src = traffic_source();
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_EVENTS == 1)) */
+
+
+/*
+ * ----- Function: aedea_set_timer_slack() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1))
+bool_t aedea_set_timer_slack(aedea_tmr_handle_t handle, port_uint_t slack_ticks)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer the handle refers to.
+     port_uint_t num_ticks;   // Number of ticks left until the timer's requested expiry.
+
+     TMR_LOCK();
+
+     // Return FALSE if the handle is stale.
+     tmr_ptr = tmr_from_handle(handle);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     tmr_ptr->slack = slack_ticks;
+
+     // A running timer is re-armed for its requested expiry with the new slack.
+     if(TMR_STATE_ARMED == tmr_ptr->state)
+     {
+#if((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1))
+          tmr_catch_up();
+#endif    /* ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1)) */
+
+          num_ticks = tmr_remaining(tmr_ptr) - tmr_ptr->slack_delay;
+          tmr_disarm(tmr_ptr);
+          tmr_arm(tmr_ptr, num_ticks);
+
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+          tickless_program();
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+     }
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1)) */
+
+
+/*
+ * ----- Function: tmr_apply_slack() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1))
+static port_uint_t tmr_apply_slack(sw_tmr_t * tmr_ptr, port_uint_t num_ticks)
+{
+     port_uint_t expiry;      // Requested expiry tick.
+     port_uint_t limit;       // Latest acceptable expiry tick.
+     port_uint_t mask;        // Highest bit in which the requested and the latest expiry tick differ.
+
+     expiry = tick_count + num_ticks;
+     limit = expiry + tmr_ptr->slack;
+
+     // Clear all bits of the latest acceptable tick below the highest bit in which it
+     // differs from the requested one. The result is the tick in the window with the
+     // most trailing zero bits, which timers with overlapping windows tend to share.
+     mask = expiry ^ limit;
+     while(0 != (mask & (mask - 1)))
+     {
+          mask &= (mask - 1);
+     }
+
+     if(0 != mask)
+     {
+          limit &= ~(mask - 1);
+     }
+
+     tmr_ptr->slack_delay = (port_uint_t)(limit - expiry);
+
+     return num_ticks + tmr_ptr->slack_delay;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1)) */
+
+
+/*
+ * ----- Function: aedea_now() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+aedea_time_t aedea_now(void)
+{
+     return PORT_CLOCK_NS();
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*
+ * ----- Function: aedea_install_timer_ns() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+bool_t aedea_install_timer_ns(
+                              aedea_tmr_handle_t * handle_ptr,
+                              timeout_handler_t * handler,
+                              void * handler_arg_ptr,
+                              uint8_t timer_id,
+                              aedea_time_t time_ns,
+                              uint8_t flags
+                             )
+{
+     sw_tmr_t * tmr_ptr;      // The software timer allocated for the new timeout handler.
+     aedea_time_t deadline;   // Absolute deadline of the timer.
+
+     // An absolute deadline does not define a period.
+     if((0 != (flags & AEDEA_TMR_PERIODIC)) && (0 != (flags & AEDEA_TMR_ABS_TIME)))
+     {
+          return FALSE;
+     }
+
+     TMR_LOCK();
+
+     // The timer is armed as a one-shot tick timer, the period is kept in nanoseconds.
+     deadline = tmr_ns_deadline(time_ns, flags);
+     tmr_ptr = tmr_alloc(handler, handler_arg_ptr, timer_id, tmr_ns_to_ticks(deadline), (uint8_t)(flags & AEDEA_TMR_HARD));
+     if(NULL != tmr_ptr)
+     {
+          tmr_ptr->by_handle = TRUE;
+          tmr_ptr->ns_mode = TRUE;
+          tmr_ptr->deadline = deadline;
+          tmr_ptr->period_ns = 0;
+
+          if(0 != (flags & AEDEA_TMR_PERIODIC))
+          {
+               tmr_ptr->period_ns = (0 == time_ns) ? AEDEA_OPT_TMR_TICK_NS : time_ns;
+          }
+
+          handle_ptr->slot = (port_uint_t)(tmr_ptr - sw_tmrs);
+          handle_ptr->gen = tmr_ptr->gen;
+     }
+
+     TMR_UNLOCK();
+
+     return (NULL != tmr_ptr) ? TRUE : FALSE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*
+ * ----- Function: aedea_rearm_timer_ns() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+bool_t aedea_rearm_timer_ns(aedea_tmr_handle_t handle, aedea_time_t time_ns, uint8_t flags)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer the handle refers to.
+     bool_t periodic;         // TRUE if the timer is periodic.
+     aedea_time_t deadline;   // Absolute deadline of the timer.
+
+     TMR_LOCK();
+
+     // Return FALSE if the handle is stale.
+     tmr_ptr = tmr_from_handle(handle);
+     if(NULL == tmr_ptr)
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     // Return FALSE if an absolute deadline is given for a periodic timer.
+     periodic = ((0 != tmr_ptr->period) || ((TRUE == tmr_ptr->ns_mode) && (0 != tmr_ptr->period_ns))) ? TRUE : FALSE;
+     if((TRUE == periodic) && (0 != (flags & AEDEA_TMR_ABS_TIME)))
+     {
+          TMR_UNLOCK();
+          return FALSE;
+     }
+
+     // Re-arm the timer as a one-shot tick timer and switch it to nanosecond mode.
+     deadline = tmr_ns_deadline(time_ns, flags);
+     tmr_ptr->period = 0;
+     tmr_restart(tmr_ptr, tmr_ns_to_ticks(deadline));
+
+     tmr_ptr->ns_mode = TRUE;
+     tmr_ptr->deadline = deadline;
+     tmr_ptr->period_ns = 0;
+
+     if(TRUE == periodic)
+     {
+          tmr_ptr->period_ns = (0 == time_ns) ? AEDEA_OPT_TMR_TICK_NS : time_ns;
+     }
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*
+ * ----- Function: tmr_ns_deadline() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+static aedea_time_t tmr_ns_deadline(aedea_time_t time_ns, uint8_t flags)
+{
+     // A relative timeout is converted to an absolute deadline, the sum may wrap around.
+     return (0 != (flags & AEDEA_TMR_ABS_TIME)) ? time_ns : (PORT_CLOCK_NS() + time_ns);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*
+ * ----- Function: tmr_ns_to_ticks() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+static port_uint_t tmr_ns_to_ticks(aedea_time_t deadline)
+{
+     aedea_time_t remaining;  // Nanoseconds left until the deadline.
+
+     // The deadline has passed if the wrap-safe difference is not positive, the timer
+     // then expires on the next tick.
+     remaining = deadline - PORT_CLOCK_NS();
+     if(0 >= (int64_t)remaining)
+     {
+          return 1;
+     }
+
+     // Round up to whole ticks, timeouts beyond the tick range are armed in steps.
+     if((remaining / AEDEA_OPT_TMR_TICK_NS) >= TMR_NS_MAX_TICKS)
+     {
+          return TMR_NS_MAX_TICKS;
+     }
+
+     return (port_uint_t)((remaining + (AEDEA_OPT_TMR_TICK_NS - 1)) / AEDEA_OPT_TMR_TICK_NS);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*
+ * ----- Function: tmr_alloc() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static sw_tmr_t * tmr_alloc(timeout_handler_t * handler, void * handler_arg_ptr, uint8_t timer_id, port_uint_t num_ticks, uint8_t flags)
+{
+     sw_tmr_t * tmr_ptr;      // The software timer taken off the free list.
+
+#if(AEDEA_OPT_USE_HARD_TMRS == 0)
+     // Hard timers are not compiled in, a hard timer must not silently become a soft one.
+     if(0 != (flags & AEDEA_TMR_HARD))
+     {
+          return NULL;
+     }
+#endif    /* (AEDEA_OPT_USE_HARD_TMRS == 0) */
+
+     // Take a software timer off the free list, return NULL if none is left.
+     tmr_ptr = tmr_free_ptr;
+     if(NULL == tmr_ptr)
+     {
+          return NULL;
+     }
+     tmr_free_ptr = tmr_ptr->next_ptr;
+
+     // Initialize the timer and arm it.
+     tmr_ptr->handler = handler;
+     tmr_ptr->handler_arg_ptr = handler_arg_ptr;
+     tmr_ptr->timer_id = timer_id;
+     tmr_ptr->pending = FALSE;
+     tmr_ptr->by_handle = FALSE;
+     tmr_ptr->period = 0;
+#if(AEDEA_OPT_USE_HARD_TMRS == 1)
+     tmr_ptr->hard = (0 != (flags & AEDEA_TMR_HARD)) ? TRUE : FALSE;
+#endif    /* (AEDEA_OPT_USE_HARD_TMRS == 1) */
+#if(AEDEA_OPT_USE_TMR_GROUPS == 1)
+     tmr_ptr->group = AEDEA_TMR_NO_GROUP;
+#endif    /* (AEDEA_OPT_USE_TMR_GROUPS == 1) */
+#if(AEDEA_OPT_USE_TMR_EVENTS == 1)
+     tmr_ptr->evt_item_ptr = NULL;
+#endif    /* (AEDEA_OPT_USE_TMR_EVENTS == 1) */
+#if(AEDEA_OPT_USE_TMR_SLACK == 1)
+     tmr_ptr->slack = 0;
+     tmr_ptr->slack_delay = 0;
+#endif    /* (AEDEA_OPT_USE_TMR_SLACK == 1) */
+#if(AEDEA_OPT_USE_CLOCK_NS == 1)
+     tmr_ptr->ns_mode = FALSE;
+#endif    /* (AEDEA_OPT_USE_CLOCK_NS == 1) */
+#if(AEDEA_OPT_USE_TMR_LATENESS == 1)
+     tmr_late_clear(&(tmr_ptr->late));
+#endif    /* (AEDEA_OPT_USE_TMR_LATENESS == 1) */
+
+     if(0 != (flags & AEDEA_TMR_PERIODIC))
+     {
+          tmr_ptr->period = (0 == num_ticks) ? 1 : num_ticks;
+     }
+
+#if((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1))
+     tmr_catch_up();
+#endif    /* ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1)) */
+
+     tmr_arm(tmr_ptr, num_ticks);
+
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+     tickless_program();
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+     trace_record(AEDEA_TRACE_TMR_INSTALL, timer_id, num_ticks);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+     // Increment the number of installed timers.
+     num_timers++;
+
+     return tmr_ptr;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_free() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static void tmr_free(sw_tmr_t * tmr_ptr)
+{
+     // Unlink the timer if it is still running.
+     if(TMR_STATE_ARMED == tmr_ptr->state)
+     {
+          tmr_disarm(tmr_ptr);
+     }
+
+#if(AEDEA_OPT_USE_TMR_GROUPS == 1)
+     // Remove the timer from its group.
+     tmr_group_unlink(tmr_ptr);
+#endif    /* (AEDEA_OPT_USE_TMR_GROUPS == 1) */
+
+     // Invalidate all handles to the timer and return it to the free list. If the
+     // timer is still in the expired timers queue, the entry is skipped by the timer
+     // process (or picked up by the next user of the timer).
+     tmr_ptr->state = TMR_STATE_FREE;
+     tmr_ptr->pending = FALSE;
+     tmr_ptr->gen++;
+     tmr_ptr->next_ptr = tmr_free_ptr;
+     tmr_free_ptr = tmr_ptr;
+
+     // Decrement the number of installed timers.
+     num_timers--;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_restart() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static void tmr_restart(sw_tmr_t * tmr_ptr, port_uint_t num_ticks)
+{
+     // Unlink the timer if it is still running. An expiry still waiting for the
+     // timeout handler to be called is dropped.
+     if(TMR_STATE_ARMED == tmr_ptr->state)
+     {
+          tmr_disarm(tmr_ptr);
+     }
+     tmr_ptr->pending = FALSE;
+
+#if(AEDEA_OPT_USE_CLOCK_NS == 1)
+     // A tick timeout switches a nanosecond timer back to tick mode.
+     if((TRUE == tmr_ptr->ns_mode) && (0 != tmr_ptr->period_ns))
+     {
+          tmr_ptr->period = 1;
+     }
+     tmr_ptr->ns_mode = FALSE;
+#endif    /* (AEDEA_OPT_USE_CLOCK_NS == 1) */
+
+     // The new timeout value also becomes the period of a periodic timer.
+     if(0 != tmr_ptr->period)
+     {
+          tmr_ptr->period = (0 == num_ticks) ? 1 : num_ticks;
+     }
+
+#if((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1))
+     tmr_catch_up();
+#endif    /* ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1)) */
+
+     tmr_arm(tmr_ptr, num_ticks);
+
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+     tickless_program();
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_from_handle() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static sw_tmr_t * tmr_from_handle(aedea_tmr_handle_t handle)
+{
+     // The handle is valid only if the slot exists, is in use and has not been
+     // freed since the handle was issued.
+     if((AEDEA_OPT_MAX_SOFT_TMRS <= handle.slot) ||
+        (TMR_STATE_FREE == sw_tmrs[handle.slot].state) ||
+        (handle.gen != sw_tmrs[handle.slot].gen))
+     {
+          return NULL;
+     }
+
+     return &(sw_tmrs[handle.slot]);
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_find() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static sw_tmr_t * tmr_find(uint8_t timer_id)
+{
+     port_uint_t n = 0;
+
+     // Search the installed timers for the specified timer ID, the IDs of timers installed
+     // with a handle need not be unique and are never looked up.
+     for(n = 0; n < AEDEA_OPT_MAX_SOFT_TMRS; n++)
+     {
+          if((TMR_STATE_FREE != sw_tmrs[n].state) && (FALSE == sw_tmrs[n].by_handle) && (timer_id == sw_tmrs[n].timer_id))
+          {
+               return &(sw_tmrs[n]);
+          }
+     }
+
+     return NULL;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_expire() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static void tmr_expire(sw_tmr_t * tmr_ptr)
+{
+     port_uint_t index;       // Index of the timer in the sw_tmrs pool.
+
+     // The timer stays installed until it is deleted. A periodic timer is re-armed
+     // right away relative to the tick it was due on, so its phase does not drift
+     // with the timer process' latency. A one-shot timer can be re-armed with
+     // aedea_refresh_timer() or aedea_rearm_timer().
+#if(AEDEA_OPT_USE_CLOCK_NS == 1)
+     // A nanosecond timer fires early if the tick phase was not aligned with the clock
+     // or the deadline was out of the tick range, it is re-armed for the remainder.
+     // A periodic nanosecond timer advances its deadline by exactly one period.
+     if(TRUE == tmr_ptr->ns_mode)
+     {
+          if(0 < (int64_t)(tmr_ptr->deadline - PORT_CLOCK_NS()))
+          {
+               tmr_arm(tmr_ptr, tmr_ns_to_ticks(tmr_ptr->deadline));
+               return;
+          }
+
+          if(0 != tmr_ptr->period_ns)
+          {
+               tmr_ptr->deadline += tmr_ptr->period_ns;
+               tmr_arm(tmr_ptr, tmr_ns_to_ticks(tmr_ptr->deadline));
+          }
+          else
+          {
+               tmr_ptr->state = TMR_STATE_EXPIRED;
+          }
+     }
+     else
+#endif    /* (AEDEA_OPT_USE_CLOCK_NS == 1) */
+     if(0 != tmr_ptr->period)
+     {
+#if(AEDEA_OPT_USE_TMR_SLACK == 1)
+          // The period is counted from the requested expiry, not the delayed one.
+          tmr_arm(tmr_ptr, (tmr_ptr->period > tmr_ptr->slack_delay) ? (tmr_ptr->period - tmr_ptr->slack_delay) : 1);
+#else
+          tmr_arm(tmr_ptr, tmr_ptr->period);
+#endif    /* (AEDEA_OPT_USE_TMR_SLACK == 1) */
+     }
+     else
+     {
+          tmr_ptr->state = TMR_STATE_EXPIRED;
+     }
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+     trace_record(AEDEA_TRACE_TMR_EXPIRE, tmr_ptr->timer_id, 0);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+     PROBE1(timer_expire, tmr_ptr->timer_id);
+
+#if(AEDEA_OPT_USE_HARD_TMRS == 1)
+     // A hard timer's handler is called right away. The timer is already re-armed or
+     // expired, so the handler may re-arm or cancel it.
+     if(TRUE == tmr_ptr->hard)
+     {
+          tmr_ptr->handler(tmr_ptr->timer_id, tmr_ptr->handler_arg_ptr);
+          return;
+     }
+#endif    /* (AEDEA_OPT_USE_HARD_TMRS == 1) */
+
+#if(AEDEA_OPT_USE_TMR_EVENTS == 1)
+     // A bound timer posts its event directly to its process, the timer process is
+     // not involved.
+     if(NULL != tmr_ptr->evt_item_ptr)
+     {
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+          traffic_post(tmr_ptr->pid, tmr_ptr->evt_item_ptr, tmr_ptr->src);
+#else
+          (void)aedea_post_event(tmr_ptr->pid, tmr_ptr->evt_item_ptr);
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+          return;
+     }
+#endif    /* (AEDEA_OPT_USE_TMR_EVENTS == 1) */
+
+     // Only the timer's index is queued for the timer process and each timer is
+     // queued at most once, the timer process checks the pending flag before
+     // calling the handler. If a periodic timer expires again before its handler
+     // was called, the expiries are merged into one call.
+#if(AEDEA_OPT_USE_TMR_LATENESS == 1)
+     // The lateness is measured from the first of merged expiries, each further one
+     // is a missed period.
+     if(TRUE == tmr_ptr->pending)
+     {
+          tmr_ptr->late.missed++;
+          tmr_late.missed++;
+     }
+     else
+     {
+          tmr_ptr->due_tick = tick_count;
+     }
+#endif    /* (AEDEA_OPT_USE_TMR_LATENESS == 1) */
+
+     tmr_ptr->pending = TRUE;
+
+     if(FALSE == tmr_ptr->queued)
+     {
+          index = (port_uint_t)(tmr_ptr - sw_tmrs);
+          tmr_ptr->queued = queue_push_item(&exp_tmr_queue, &index);
+     }
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_unlink() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static void tmr_unlink(sw_tmr_t * tmr_ptr)
+{
+     // Point the previous link at the next timer and, if there is one, point the
+     // next timer back at the previous link.
+     *(tmr_ptr->prev_link_ptr) = tmr_ptr->next_ptr;
+
+     if(NULL != tmr_ptr->next_ptr)
+     {
+          tmr_ptr->next_ptr->prev_link_ptr = tmr_ptr->prev_link_ptr;
+     }
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_link() -----
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+static void tmr_link(sw_tmr_t ** link_ptr, sw_tmr_t * tmr_ptr)
+{
+     // Insert the timer in front of the timer the link currently points at.
+     tmr_ptr->next_ptr = *link_ptr;
+     tmr_ptr->prev_link_ptr = link_ptr;
+
+     if(NULL != tmr_ptr->next_ptr)
+     {
+          tmr_ptr->next_ptr->prev_link_ptr = &(tmr_ptr->next_ptr);
+     }
+
+     *link_ptr = tmr_ptr;
+}
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*
+ * ----- Function: tmr_arm() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0))
+static void tmr_arm(sw_tmr_t * tmr_ptr, port_uint_t num_ticks)
+{
+     sw_tmr_t ** link_ptr;    // Link the new timer is inserted at.
+
+     // A timeout of zero ticks expires on the next tick.
+     if(0 == num_ticks)
+     {
+          num_ticks = 1;
+     }
+
+#if(AEDEA_OPT_USE_TMR_SLACK == 1)
+     num_ticks = tmr_apply_slack(tmr_ptr, num_ticks);
+#endif    /* (AEDEA_OPT_USE_TMR_SLACK == 1) */
+
+     // Walk the delta list, subtracting the relative timeout of each timer due
+     // before (or together with) the new one. Timers with equal timeouts expire in
+     // the order they were armed.
+     link_ptr = &tmr_list_ptr;
+     while((NULL != *link_ptr) && ((*link_ptr)->num_ticks <= num_ticks))
+     {
+          num_ticks -= (*link_ptr)->num_ticks;
+          link_ptr = &((*link_ptr)->next_ptr);
+     }
+
+     // Link the new timer and adjust the relative timeout of the timer immediately
+     // below it (if any).
+     tmr_ptr->num_ticks = num_ticks;
+     tmr_link(link_ptr, tmr_ptr);
+
+     if(NULL != tmr_ptr->next_ptr)
+     {
+          tmr_ptr->next_ptr->num_ticks -= num_ticks;
+     }
+
+     tmr_ptr->state = TMR_STATE_ARMED;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0)) */
+
+
+/*
+ * ----- Function: tmr_disarm() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0))
+static void tmr_disarm(sw_tmr_t * tmr_ptr)
+{
+     // Hand the timer's remaining relative timeout to the timer immediately below it.
+     if(NULL != tmr_ptr->next_ptr)
+     {
+          tmr_ptr->next_ptr->num_ticks += tmr_ptr->num_ticks;
+     }
+
+     tmr_unlink(tmr_ptr);
+     tmr_ptr->state = TMR_STATE_EXPIRED;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0)) */
+
+
+/*
+ * ----- Function: tmr_tick() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0))
+static void tmr_tick(port_uint_t num_ticks)
+{
+     sw_tmr_t * tmr_ptr;      // Timer at the head of the delta list.
+
+     // If no timer is running, return.
+     if(NULL == tmr_list_ptr)
+     {
+          return;
+     }
+
+     // Subtract the elapsed ticks from the top timer's number of ticks, the top timer
+     // is not due before the last of them.
+     tmr_list_ptr->num_ticks -= num_ticks;
+
+     // Expire the top timer and any below it with a relative timeout of zero.
+     while((NULL != tmr_list_ptr) && (0 == tmr_list_ptr->num_ticks))
+     {
+          tmr_ptr = tmr_list_ptr;
+          tmr_unlink(tmr_ptr);
+          tmr_expire(tmr_ptr);
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0)) */
+
+
+/*
+ * ----- Function: tmr_next_expiry() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0))
+static port_uint_t tmr_next_expiry(void)
+{
+     // The top timer's relative timeout is the number of ticks until it expires.
+     return (NULL == tmr_list_ptr) ? AEDEA_TMR_NO_EXPIRY : tmr_list_ptr->num_ticks;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0)) */
+
+
+/*
+ * ----- Function: tmr_remaining() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0) && (AEDEA_OPT_USE_TMR_SLACK == 1))
+static port_uint_t tmr_remaining(sw_tmr_t * tmr_ptr)
+{
+     port_uint_t num_ticks = 0;
+     sw_tmr_t * list_ptr;
+
+     // Sum up the relative timeouts from the top of the delta list to the timer.
+     for(list_ptr = tmr_list_ptr; tmr_ptr != list_ptr; list_ptr = list_ptr->next_ptr)
+     {
+          num_ticks += list_ptr->num_ticks;
+     }
+
+     return num_ticks + tmr_ptr->num_ticks;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 0) && (AEDEA_OPT_USE_TMR_SLACK == 1)) */
+
+
+/*
+ * ----- Function: tmr_arm() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static void tmr_arm(sw_tmr_t * tmr_ptr, port_uint_t num_ticks)
+{
+     // A timeout of zero ticks expires on the next tick.
+     if(0 == num_ticks)
+     {
+          num_ticks = 1;
+     }
+
+#if(AEDEA_OPT_USE_TMR_SLACK == 1)
+     num_ticks = tmr_apply_slack(tmr_ptr, num_ticks);
+#endif    /* (AEDEA_OPT_USE_TMR_SLACK == 1) */
+
+     // Wheel timers store their absolute expiry tick.
+     tmr_ptr->num_ticks = tmr_wheel_now + num_ticks;
+     tmr_wheel_link(tmr_ptr);
+
+     tmr_ptr->state = TMR_STATE_ARMED;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*
+ * ----- Function: tmr_disarm() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static void tmr_disarm(sw_tmr_t * tmr_ptr)
+{
+     tmr_unlink(tmr_ptr);
+     tmr_ptr->state = TMR_STATE_EXPIRED;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*
+ * ----- Function: tmr_wheel_link() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static void tmr_wheel_link(sw_tmr_t * tmr_ptr)
+{
+     port_uint_t delta;       // Number of ticks until the timer expires.
+     port_uint_t expiry;      // Expiry tick used to select the slot.
+     port_uint_t level = 0;
+
+     delta = (port_uint_t)(tmr_ptr->num_ticks - tmr_wheel_now);
+     expiry = tmr_ptr->num_ticks;
+
+     // Select the lowest level whose range covers the timeout. Each level's range is
+     // TMR_WHEEL_SLOTS times that of the level below it.
+     while(((AEDEA_OPT_TMR_WHEEL_LEVELS - 1) > level) &&
+           (delta >= ((port_uint_t)1 << (AEDEA_OPT_TMR_WHEEL_BITS * (level + 1)))))
+     {
+          level++;
+     }
+
+     // Timeouts beyond the range of the wheel are parked in the farthest slot of the
+     // top level, they are placed again with their real expiry tick when that slot
+     // is cascaded.
+     if(delta >= TMR_WHEEL_RANGE)
+     {
+          expiry = tmr_wheel_now + (TMR_WHEEL_RANGE - 1);
+     }
+
+     tmr_link(&(tmr_wheel[level][(expiry >> (AEDEA_OPT_TMR_WHEEL_BITS * level)) & TMR_WHEEL_MASK]), tmr_ptr);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*
+ * ----- Function: tmr_tick() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static void tmr_tick(port_uint_t num_ticks)
+{
+     sw_tmr_t * tmr_ptr;      // Timer being cascaded or expired.
+     sw_tmr_t * next_ptr;     // Timer following tmr_ptr in the detached list.
+     port_uint_t level = 0;
+     port_uint_t index = 0;
+
+     // Advance the wheel. No slot has to be expired or cascaded before the last of
+     // the elapsed ticks.
+     tmr_wheel_now += num_ticks;
+
+     // Each time the index of a level wraps around, cascade the current slot of the
+     // level above it into the lower levels.
+     for(level = 1; level < AEDEA_OPT_TMR_WHEEL_LEVELS; level++)
+     {
+          if(0 != ((tmr_wheel_now >> (AEDEA_OPT_TMR_WHEEL_BITS * (level - 1))) & TMR_WHEEL_MASK))
+          {
+               break;
+          }
+
+          // Detach the slot's list and place each of its timers again.
+          index = (tmr_wheel_now >> (AEDEA_OPT_TMR_WHEEL_BITS * level)) & TMR_WHEEL_MASK;
+          tmr_ptr = tmr_wheel[level][index];
+          tmr_wheel[level][index] = NULL;
+
+          while(NULL != tmr_ptr)
+          {
+               next_ptr = tmr_ptr->next_ptr;
+               tmr_wheel_link(tmr_ptr);
+               tmr_ptr = next_ptr;
+          }
+     }
+
+     // All timers in the current slot of the lowest level expire on this tick. They
+     // are unlinked one at a time, a hard timer's handler may cancel timers in the
+     // same slot. Re-armed timers never land in the current slot again.
+     index = tmr_wheel_now & TMR_WHEEL_MASK;
+
+     while(NULL != tmr_wheel[0][index])
+     {
+          tmr_ptr = tmr_wheel[0][index];
+          tmr_unlink(tmr_ptr);
+          tmr_expire(tmr_ptr);
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*
+ * ----- Function: tmr_next_expiry() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+static port_uint_t tmr_next_expiry(void)
+{
+     port_uint_t next_ticks = AEDEA_TMR_NO_EXPIRY;     // Smallest number of ticks found so far.
+     port_uint_t num_ticks;                            // Number of ticks until the slot being checked is reached.
+     port_uint_t level = 0;
+     port_uint_t index = 0;
+     port_uint_t n = 0;
+
+     // Timers in the lowest level expire within one revolution, the first occupied
+     // slot after the current one holds the earliest of them.
+     index = tmr_wheel_now & TMR_WHEEL_MASK;
+     for(n = 1; n < TMR_WHEEL_SLOTS; n++)
+     {
+          if(NULL != tmr_wheel[0][(index + n) & TMR_WHEEL_MASK])
+          {
+               next_ticks = n;
+               break;
+          }
+     }
+
+     // Timers in the upper levels expire no earlier than the tick their slot is
+     // cascaded on. That tick is used as the deadline, waking up early only costs
+     // the cascade.
+     for(level = 1; level < AEDEA_OPT_TMR_WHEEL_LEVELS; level++)
+     {
+          index = (tmr_wheel_now >> (AEDEA_OPT_TMR_WHEEL_BITS * level)) & TMR_WHEEL_MASK;
+
+          for(n = 1; n <= TMR_WHEEL_SLOTS; n++)
+          {
+               if(NULL != tmr_wheel[level][(index + n) & TMR_WHEEL_MASK])
+               {
+                    // The slot is cascaded n level-sized steps after the start of the
+                    // current step of this level.
+                    num_ticks = (n << (AEDEA_OPT_TMR_WHEEL_BITS * level)) -
+                                (tmr_wheel_now & (((port_uint_t)1 << (AEDEA_OPT_TMR_WHEEL_BITS * level)) - 1));
+                    if(num_ticks < next_ticks)
+                    {
+                         next_ticks = num_ticks;
+                    }
+                    break;
+               }
+          }
+     }
+
+     return next_ticks;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*
+ * ----- Function: tmr_remaining() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1))
+static port_uint_t tmr_remaining(sw_tmr_t * tmr_ptr)
+{
+     // Wheel timers store their absolute expiry tick.
+     return (port_uint_t)(tmr_ptr->num_ticks - tmr_wheel_now);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1)) */
+
+
+/*
+ * ----- Function: aedea_post_event() -----
+ */
+bool_t aedea_post_event(port_uint_t pid, void * evt_item_ptr)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+     
+     // Process IDs are 8 bits wide, a larger ID must not alias a valid one.
+     if(pid > 0xFF)
+     {
+          return FALSE;
+     }
+
+     // Search for the process with the specified process ID.
+     proc_mgr_ptr = find_proc_mgr((uint8_t)pid);
+     
+     // Return FALSE if a process with the specified ID was not found.
+     if(NULL == proc_mgr_ptr)
+     {
+          return FALSE;
+     }
+
+     // Push the new event item on to the event queue.
+     if(FALSE == queue_push_item(&(proc_mgr_ptr->event_queue), evt_item_ptr))
+     {
+          return FALSE;
+     }
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     traffic_record(proc_mgr_ptr, traffic_source());
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+     return TRUE;
+}
+
+
+/*
+ * ----- Function: aedea_post_event_after() -----
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+bool_t aedea_post_event_after(port_uint_t pid, void * evt_item_ptr, port_uint_t num_ticks)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+     dly_evt_t * dly_evt_ptr;      // The delayed event allocated for this event item.
+     dly_evt_t * prev_ptr;         // Delayed event after which the new one is inserted.
+     dly_evt_t * next_ptr;         // Delayed event before which the new one is inserted.
+
+     // Post the event immediately if no delay is requested.
+     if(0 == num_ticks)
+     {
+          return aedea_post_event(pid, evt_item_ptr);
+     }
+
+     // Process IDs are 8 bits wide, a larger ID must not alias a valid one.
+     if(pid > 0xFF)
+     {
+          return FALSE;
+     }
+
+     // Return FALSE if a process with the specified ID was not found or if its
+     // event items do not fit into a delayed event.
+     proc_mgr_ptr = find_proc_mgr((uint8_t)pid);
+     if((NULL == proc_mgr_ptr) || (proc_mgr_ptr->event_queue.item_size > AEDEA_OPT_DELAYED_EVT_SIZE))
+     {
+          return FALSE;
+     }
+
+     // Take a delayed event off the free list, return FALSE if none is left.
+     TMR_LOCK();
+
+     dly_evt_ptr = dly_evt_free_ptr;
+     if(NULL != dly_evt_ptr)
+     {
+          dly_evt_free_ptr = dly_evt_ptr->next_ptr;
+     }
+
+     TMR_UNLOCK();
+
+     if(NULL == dly_evt_ptr)
+     {
+          return FALSE;
+     }
+
+     // The delayed event is not linked yet, the event item can be copied with
+     // interrupts enabled.
+     dly_evt_ptr->pid = (uint8_t)pid;
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     dly_evt_ptr->src = traffic_source();
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+     queue_copy_item(evt_item_ptr, dly_evt_ptr->evt_item, proc_mgr_ptr->event_queue.item_size);
+
+     TMR_LOCK();
+
+#if((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1))
+     tmr_catch_up();
+#endif    /* ((AEDEA_OPT_TMR_TICKLESS == 1) || (AEDEA_OPT_TMR_DEFERRED_TICK == 1)) */
+
+     // Walk the delta list, subtracting the relative timeout of each delayed event
+     // due before the new one.
+     prev_ptr = NULL;
+     next_ptr = dly_evt_head_ptr;
+     while((NULL != next_ptr) && (next_ptr->num_ticks <= num_ticks))
+     {
+          num_ticks -= next_ptr->num_ticks;
+          prev_ptr = next_ptr;
+          next_ptr = next_ptr->next_ptr;
+     }
+
+     // Link the new delayed event and adjust the relative timeout of its successor.
+     dly_evt_ptr->num_ticks = num_ticks;
+     dly_evt_ptr->next_ptr = next_ptr;
+
+     if(NULL != next_ptr)
+     {
+          next_ptr->num_ticks -= num_ticks;
+     }
+
+     if(NULL == prev_ptr)
+     {
+          dly_evt_head_ptr = dly_evt_ptr;
+     }
+     else
+     {
+          prev_ptr->next_ptr = dly_evt_ptr;
+     }
+
+#if(AEDEA_OPT_TMR_TICKLESS == 1)
+     tickless_program();
+#endif    /* (AEDEA_OPT_TMR_TICKLESS == 1) */
+
+     TMR_UNLOCK();
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
+/*
+ * ----- Function: dly_evt_tick() -----
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+static void dly_evt_tick(port_uint_t num_ticks)
+{
+     dly_evt_t * dly_evt_ptr;      // Delayed event being posted.
+
+     // Return if there are no pending delayed events.
+     if(NULL == dly_evt_head_ptr)
+     {
+          return;
+     }
+
+     // Subtract the elapsed ticks from the first delayed event's number of ticks, it
+     // is not due before the last of them.
+     dly_evt_head_ptr->num_ticks -= num_ticks;
+
+     // Post all delayed events at the head of the list which are due and return
+     // them to the free list.
+     while((NULL != dly_evt_head_ptr) && (0 == dly_evt_head_ptr->num_ticks))
+     {
+          dly_evt_ptr = dly_evt_head_ptr;
+          dly_evt_head_ptr = dly_evt_ptr->next_ptr;
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+          traffic_post(dly_evt_ptr->pid, dly_evt_ptr->evt_item, dly_evt_ptr->src);
+#else
+          aedea_post_event(dly_evt_ptr->pid, dly_evt_ptr->evt_item);
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+          dly_evt_ptr->next_ptr = dly_evt_free_ptr;
+          dly_evt_free_ptr = dly_evt_ptr;
+     }
+}
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
+/*
+ * ----- Function: dly_evt_next_expiry() -----
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+static port_uint_t dly_evt_next_expiry(void)
+{
+     // The first delayed event's relative timeout is the number of ticks until it is due.
+     return (NULL == dly_evt_head_ptr) ? AEDEA_TMR_NO_EXPIRY : dly_evt_head_ptr->num_ticks;
+}
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
+/*
+ * ----- Function: aedea_get_event() -----
+ */
+bool_t aedea_get_event(void * evt_item_ptr)
+{
+     // Pop an event item on from the event queue.
+     return queue_pop_item(&(active_proc_mgr->event_queue), evt_item_ptr);
+}
+
+
+/*
+ * ----- Function: aedea_set_event_ttl() -----
+ */
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+bool_t aedea_set_event_ttl(uint8_t pid, port_uint_t ttl_ticks, port_uint_t * stamp_buff_ptr)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+     queue_t * queue_ptr;          // Pointer to the process' event queue.
+     port_uint_t n = 0;
+
+     // Return FALSE if a process with the specified ID was not found or if a TTL
+     // is requested without a stamp buffer.
+     proc_mgr_ptr = find_proc_mgr(pid);
+     if((NULL == proc_mgr_ptr) || ((0 != ttl_ticks) && (NULL == stamp_buff_ptr)))
+     {
+          return FALSE;
+     }
+
+     queue_ptr = &(proc_mgr_ptr->event_queue);
+
+     QUEUE_LOCK(queue_ptr);
+
+     // Stamp events already present in the queue with the current tick, they
+     // have not been stamped on posting.
+     if(0 != ttl_ticks)
+     {
+          for(n = 0; n < queue_ptr->num_items; n++)
+          {
+               stamp_buff_ptr[n] = tick_count;
+          }
+     }
+
+     queue_ptr->ttl = ttl_ticks;
+     queue_ptr->stamp_ptr = (0 != ttl_ticks) ? stamp_buff_ptr : NULL;
+
+     QUEUE_UNLOCK(queue_ptr);
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+
+/*
+ * ----- Function: aedea_get_expired_event_count() -----
+ */
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+port_uint_t aedea_get_expired_event_count(uint8_t pid)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+
+     proc_mgr_ptr = find_proc_mgr(pid);
+     if(NULL == proc_mgr_ptr)
+     {
+          return 0;
+     }
+
+     return proc_mgr_ptr->event_queue.num_expired;
+}
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+
+/*
+ * ----- Function: aedea_set_latency_buffer() -----
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+bool_t aedea_set_latency_buffer(uint8_t pid, port_uint_t * stamp_buff_ptr)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+     queue_t * queue_ptr;          // Pointer to the process' event queue.
+     port_uint_t n;
+
+     proc_mgr_ptr = find_proc_mgr(pid);
+     if(NULL == proc_mgr_ptr)
+     {
+          return FALSE;
+     }
+
+     queue_ptr = &(proc_mgr_ptr->event_queue);
+
+     QUEUE_LOCK(queue_ptr);
+
+     // Events already present in the queue have not been stamped on posting,
+     // their latency is measured from now.
+     if(NULL != stamp_buff_ptr)
+     {
+          for(n = 0; n < queue_ptr->num_items; n++)
+          {
+               stamp_buff_ptr[n] = PORT_CYCLES();
+          }
+     }
+
+     queue_ptr->lat_stamp_ptr = stamp_buff_ptr;
+
+     QUEUE_UNLOCK(queue_ptr);
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*
+ * ----- Function: aedea_get_sched_stats() -----
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+void aedea_get_sched_stats(aedea_sched_stats_t * stats_ptr)
+{
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     *stats_ptr = sched_stats;
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+}
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*
+ * ----- Function: aedea_reset_sched_stats() -----
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+void aedea_reset_sched_stats(void)
+{
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     sched_stats.busy_calls = 0;
+     sched_stats.empty_calls = 0;
+     sched_stats.delayed_passes = 0;
+     sched_stats.disabled_passes = 0;
+     sched_stats.busy_cycles = 0;
+     sched_stats.idle_cycles = 0;
+     sched_stats.utilisation = 0;
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+}
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*
+ * ----- Function: proc_num_popped() -----
+ */
+#if((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1))
+static port_uint_t proc_num_popped(proc_mgr_t * proc_mgr_ptr)
+{
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+     // The work of the timer process are the expired timers.
+     if(PID_AEDEA_TIMER_PROCESS == proc_mgr_ptr->pid)
+     {
+          return exp_tmr_queue.num_popped;
+     }
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+     return proc_mgr_ptr->event_queue.num_popped;
+}
+#endif    /* ((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1)) */
+
+
+/*
+ * ----- Function: sched_stats_publish() -----
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+static void sched_stats_publish(void)
+{
+     unsigned long busy = sched_window.busy_cycles;
+     unsigned long total = sched_window.busy_cycles + sched_window.idle_cycles;
+
+     // Scale the window's times down so that busy * 100 cannot overflow.
+     while(total > 0xFFFFUL)
+     {
+          busy >>= 1;
+          total >>= 1;
+     }
+
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     sched_stats.busy_calls += sched_window.busy_calls;
+     sched_stats.empty_calls += sched_window.empty_calls;
+     sched_stats.delayed_passes += sched_window.delayed_passes;
+     sched_stats.disabled_passes += sched_window.disabled_passes;
+     sched_stats.busy_cycles += sched_window.busy_cycles;
+     sched_stats.idle_cycles += sched_window.idle_cycles;
+     sched_stats.utilisation = (0 != total) ? (port_uint_t)((busy * 100) / total) : 0;
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+
+     sched_window.busy_calls = 0;
+     sched_window.empty_calls = 0;
+     sched_window.delayed_passes = 0;
+     sched_window.disabled_passes = 0;
+     sched_window.busy_cycles = 0;
+     sched_window.idle_cycles = 0;
+     sched_window_passes = 0;
+}
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*
+ * ----- Function: aedea_get_traffic() -----
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+port_uint_t aedea_get_traffic(aedea_traffic_t * entries_ptr, port_uint_t max_entries)
+{
+     port_uint_t num_entries = 0;
+     port_uint_t src;
+     port_uint_t dst;
+
+     for(dst = 0; dst < num_processes; dst++)
+     {
+          // The destination's queue lock protects its column.
+          QUEUE_LOCK(&(proc_mgrs[dst].event_queue));
+
+          for(src = 0; src <= TRAFFIC_SLOTS; src++)
+          {
+               if((0 == traffic[src][dst].count) || (num_entries == max_entries))
+               {
+                    continue;
+               }
+
+               // Every process ID is valid, external posts are flagged instead.
+               entries_ptr[num_entries].external = (TRAFFIC_EXTERNAL == src) ? TRUE : FALSE;
+               entries_ptr[num_entries].src_pid = (TRAFFIC_EXTERNAL == src) ? 0 : proc_mgrs[src].pid;
+               entries_ptr[num_entries].dst_pid = proc_mgrs[dst].pid;
+               entries_ptr[num_entries].count = traffic[src][dst].count;
+               entries_ptr[num_entries].bytes = traffic[src][dst].bytes;
+               num_entries++;
+          }
+
+          QUEUE_UNLOCK(&(proc_mgrs[dst].event_queue));
+     }
+
+     return num_entries;
+}
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * ----- Function: aedea_reset_traffic() -----
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+void aedea_reset_traffic(void)
+{
+     port_uint_t src;
+     port_uint_t dst;
+
+     for(dst = 0; dst < num_processes; dst++)
+     {
+          // The destination's queue lock protects its column.
+          QUEUE_LOCK(&(proc_mgrs[dst].event_queue));
+
+          for(src = 0; src <= TRAFFIC_SLOTS; src++)
+          {
+               traffic[src][dst].count = 0;
+               traffic[src][dst].bytes = 0;
+          }
+
+          QUEUE_UNLOCK(&(proc_mgrs[dst].event_queue));
+     }
+}
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * ----- Function: traffic_source() -----
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+static port_uint_t traffic_source(void)
+{
+#ifdef PORT_IN_ISR
+     // An ISR may have interrupted a process callback.
+     if(PORT_IN_ISR())
+     {
+          return TRAFFIC_EXTERNAL;
+     }
+#endif    /* PORT_IN_ISR */
+
+     return traffic_src;
+}
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * ----- Function: traffic_record() -----
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+static void traffic_record(proc_mgr_t * dst_proc_mgr_ptr, port_uint_t src)
+{
+     port_uint_t dst = (port_uint_t)(dst_proc_mgr_ptr - proc_mgrs);
+
+     QUEUE_LOCK(&(dst_proc_mgr_ptr->event_queue));
+
+     traffic[src][dst].count++;
+     traffic[src][dst].bytes += dst_proc_mgr_ptr->event_queue.item_size;
+
+     QUEUE_UNLOCK(&(dst_proc_mgr_ptr->event_queue));
+}
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * ----- Function: traffic_post() -----
+ */
+#if((AEDEA_OPT_USE_TRAFFIC == 1) && ((AEDEA_OPT_USE_DELAYED_EVTS == 1) || (AEDEA_OPT_USE_TMR_EVENTS == 1)))
+static void traffic_post(uint8_t pid, void * evt_item_ptr, port_uint_t src)
+{
+     proc_mgr_t * proc_mgr_ptr;    // The process manager of the process the event is posted to.
+
+     // Delayed and bound timer events are posted from the timer tick or the timer
+     // process, they are counted for the process which queued them.
+     proc_mgr_ptr = find_proc_mgr(pid);
+     if((NULL != proc_mgr_ptr) && (TRUE == queue_push_item(&(proc_mgr_ptr->event_queue), evt_item_ptr)))
+     {
+          traffic_record(proc_mgr_ptr, src);
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_TRAFFIC == 1) && ((AEDEA_OPT_USE_DELAYED_EVTS == 1) || (AEDEA_OPT_USE_TMR_EVENTS == 1))) */
+
+
+/*
+ * ----- Function: aedea_read_metrics() -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+void aedea_read_metrics(aedea_metrics_t * metrics_ptr)
+{
+     port_uint_t seq;              // Sequence count before the copy.
+
+     while(TRUE)
+     {
+          // Wait for the scheduler to finish writing the block.
+          seq = PORT_ATOMIC_LOAD(&metrics_seq);
+          if(0 != (seq & 1))
+          {
+               continue;
+          }
+
+          PORT_MEMORY_BARRIER();
+          *metrics_ptr = metrics;
+          PORT_MEMORY_BARRIER();
+
+          // The copy is consistent if the block was not written in the meantime.
+          if(seq == PORT_ATOMIC_LOAD(&metrics_seq))
+          {
+               return;
+          }
+     }
+}
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*
+ * ----- Function: metrics_publish() -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+static void metrics_publish(void)
+{
+     proc_mgr_t * proc_mgr_ptr;         // Process manager being published.
+     aedea_proc_metrics_t * proc_ptr;   // Metrics of the process being published.
+     port_uint_t n;
+
+     // Only the scheduler writes the block, the odd sequence count makes readers retry.
+     PORT_ATOMIC_STORE(&metrics_seq, metrics_seq + 1);
+     PORT_MEMORY_BARRIER();
+
+     metrics.generation++;
+     metrics.num_processes = num_processes;
+
+     for(n = 0; n < num_processes; n++)
+     {
+          proc_mgr_ptr = &(proc_mgrs[n]);
+          proc_ptr = &(metrics.procs[n]);
+
+          proc_ptr->pid = proc_mgr_ptr->pid;
+
+          QUEUE_LOCK(&(proc_mgr_ptr->event_queue));
+
+          proc_ptr->queue_depth = proc_mgr_ptr->event_queue.count;
+          proc_ptr->queue_size = proc_mgr_ptr->event_queue.num_items;
+          proc_ptr->num_dropped = proc_mgr_ptr->event_queue.num_dropped;
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+          proc_ptr->num_expired = proc_mgr_ptr->event_queue.num_expired;
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+          QUEUE_UNLOCK(&(proc_mgr_ptr->event_queue));
+
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+          AEDEA_ENTER_CRITICAL_SECTION();
+
+          proc_ptr->invocations = proc_mgr_ptr->invocations;
+          proc_ptr->empty_invocations = proc_mgr_ptr->empty_invocations;
+          proc_ptr->total_cycles = proc_mgr_ptr->total_cycles;
+
+          AEDEA_EXIT_CRITICAL_SECTION();
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+     }
+
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+     TMR_LOCK();
+
+     metrics.tick_count = tick_count;
+     metrics.num_timers = num_timers;
+
+     TMR_UNLOCK();
+
+     QUEUE_LOCK(&exp_tmr_queue);
+
+     metrics.num_pending_timers = exp_tmr_queue.count;
+
+     QUEUE_UNLOCK(&exp_tmr_queue);
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+     aedea_get_sched_stats(&(metrics.sched));
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+     PORT_MEMORY_BARRIER();
+     PORT_ATOMIC_STORE(&metrics_seq, metrics_seq + 1);
+}
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*
+ * ----- Function: aedea_get_proc_stats() -----
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+bool_t aedea_get_proc_stats(uint8_t pid, aedea_proc_stats_t * stats_ptr)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+     queue_t * queue_ptr;          // Pointer to the process' event queue.
+
+     proc_mgr_ptr = find_proc_mgr(pid);
+     if(NULL == proc_mgr_ptr)
      {
           return FALSE;
      }
 
-     // Search for the timer with the specified timer ID.
-     for(n = 0; n < AEDEA_OPT_MAX_SOFT_TMRS; n++)
-     {
-          if(timer_id == sw_tmrs[n].timer_id)
-          {
-               break;
-          }
-     }
-     
-     // Return FALSE if no timer was found.
-     if(n == AEDEA_OPT_MAX_SOFT_TMRS)
+     queue_ptr = &(proc_mgr_ptr->event_queue);
+
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     stats_ptr->invocations = proc_mgr_ptr->invocations;
+     stats_ptr->empty_invocations = proc_mgr_ptr->empty_invocations;
+     stats_ptr->total_cycles = proc_mgr_ptr->total_cycles;
+     stats_ptr->max_cycles = proc_mgr_ptr->max_cycles;
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+
+     QUEUE_LOCK(queue_ptr);
+
+     stats_ptr->num_events = queue_ptr->num_popped;
+     stats_ptr->num_timed = queue_ptr->num_timed;
+     stats_ptr->total_latency = queue_ptr->total_latency;
+     stats_ptr->max_latency = queue_ptr->max_latency;
+
+     QUEUE_UNLOCK(queue_ptr);
+
+     return TRUE;
+}
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*
+ * ----- Function: aedea_reset_proc_stats() -----
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+bool_t aedea_reset_proc_stats(uint8_t pid)
+{
+     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
+
+     proc_mgr_ptr = find_proc_mgr(pid);
+     if(NULL == proc_mgr_ptr)
      {
           return FALSE;
      }
-     
-     // Make a temporary copy of the timer's pointers to the timeout handler function
-     // and argument.
-     handler = sw_tmrs[n].handler;
-     handler_arg_ptr = sw_tmrs[n].handler_arg_ptr;
-     
-     // Delete the timer.
-     aedea_delete_timer(timer_id);
 
-     // Re-install the timer with the new timeout value.
-     return aedea_install_timeout_handler(handler, handler_arg_ptr, timer_id, num_ticks);
+     proc_stats_clear(proc_mgr_ptr);
+
+     return TRUE;
 }
-#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
 
 
 /*
- * ----- Function; aedea_delete_timer() -----
+ * ----- Function: proc_stats_clear() -----
  */
-#if(AEDEA_OPT_USE_SOFT_TMR == 1)
-bool_t aedea_delete_timer(uint8_t timer_id)
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+static void proc_stats_clear(proc_mgr_t * proc_mgr_ptr)
 {
-     port_uint_t n = 0, i = 0;
-     
-     // Return FALSE if no timers have been installed.
-     if(0 == num_timers)
+     queue_t * queue_ptr = &(proc_mgr_ptr->event_queue);
+
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     proc_mgr_ptr->invocations = 0;
+     proc_mgr_ptr->empty_invocations = 0;
+     proc_mgr_ptr->total_cycles = 0;
+     proc_mgr_ptr->max_cycles = 0;
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+
+     QUEUE_LOCK(queue_ptr);
+
+     queue_ptr->num_popped = 0;
+     queue_ptr->num_timed = 0;
+     queue_ptr->total_latency = 0;
+     queue_ptr->max_latency = 0;
+
+     QUEUE_UNLOCK(queue_ptr);
+}
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*
+ * ----- Function: proc_stats_update() -----
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+static void proc_stats_update(proc_mgr_t * proc_mgr_ptr, port_uint_t cycles, port_uint_t num_popped)
+{
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     proc_mgr_ptr->invocations++;
+
+     // The process did not get any work if the pop count of its queue is unchanged.
+     if(num_popped == proc_num_popped(proc_mgr_ptr))
      {
-          return FALSE;
+          proc_mgr_ptr->empty_invocations++;
      }
 
-     // Search for the timer with the specified timer ID.
-     for(n = 0; n < AEDEA_OPT_MAX_SOFT_TMRS; n++)
+     proc_mgr_ptr->total_cycles += cycles;
+     if(cycles > proc_mgr_ptr->max_cycles)
      {
-          if(timer_id == sw_tmrs[n].timer_id)
-          {
-               break;
-          }
+          proc_mgr_ptr->max_cycles = cycles;
      }
-     
-     // Return FALSE if no timer was found.
-     if(AEDEA_OPT_MAX_SOFT_TMRS == n)
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+}
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*
+ * ----- Function: aedea_set_trace_mask() -----
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+void aedea_set_trace_mask(port_uint_t mask)
+{
+     trace_mask = mask;
+}
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
+/*
+ * ----- Function: aedea_trace_dump() -----
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+port_uint_t aedea_trace_dump(void * buff_ptr, port_uint_t buff_size)
+{
+     uint8_t * out_ptr = (uint8_t *)buff_ptr;     // Next byte to be written.
+     port_uint_t hdr[3];                          // Byte order mark, number of records and number of lost records.
+     port_uint_t num_recs;                        // Number of records copied.
+     port_uint_t index;                           // Index of the oldest record copied.
+     port_uint_t n;
+
+     if(buff_size < TRACE_DUMP_HDR_SIZE)
      {
-          return FALSE;
+          return 0;
      }
 
-     AEDEA_ENTER_CRITICAL_SECTION();
+     // The dump's own critical section is not recorded.
+     trace_quiet++;
+     TRACE_LOCK();
 
-     // If the first timer is to be deleted and there is only timer installed, just
-     // decrement the total number of timers and return. This is also applies when
-     // the timer to be deleted is the last timer. In any other case, other timers'
-     // indices have to be adjusted to delete the specified timer.
-     if(((0 == n) && (1 == num_timers)) || ((AEDEA_OPT_MAX_SOFT_TMRS - 1) == n))
+     num_recs = trace_count;
+     if(num_recs > ((buff_size - TRACE_DUMP_HDR_SIZE) / sizeof(trace_rec_t)))
      {
-          // Decrement the number of timers.
-          num_timers--;
+          num_recs = (buff_size - TRACE_DUMP_HDR_SIZE) / sizeof(trace_rec_t);
      }
-     else
+
+     out_ptr[0] = 'A';
+     out_ptr[1] = 'E';
+     out_ptr[2] = 'T';
+     out_ptr[3] = 'R';
+     out_ptr[4] = TRACE_DUMP_VERSION;
+     out_ptr[5] = (uint8_t)sizeof(port_uint_t);
+     out_ptr[6] = (uint8_t)sizeof(trace_rec_t);
+     out_ptr[7] = 0;
+     hdr[0] = 1;
+     hdr[1] = num_recs;
+     hdr[2] = trace_lost + (trace_count - num_recs);
+     queue_copy_item(hdr, out_ptr + 8, sizeof(hdr));
+     out_ptr += TRACE_DUMP_HDR_SIZE;
+
+     // Copy the newest num_recs records, oldest first.
+     index = trace_head - num_recs;
+     for(n = 0; n < num_recs; n++)
      {
-          // Adjust the number of ticks for the timer immediately below the specified timer
-          // by adding the number of ticks of the timer being deleted.
-          sw_tmrs[n + 1].num_ticks += sw_tmrs[n].num_ticks;
-          
-          // Decrement the number of timers.
-          num_timers--;
-          
-          // Shift all timers below the specified timer one index upwards, effectively
-          // deleting the timer.
-          for(i = n; i < num_timers; i++)
-          {
-               sw_tmrs[i].handler = sw_tmrs[i + 1].handler;
-               sw_tmrs[i].handler_arg_ptr = sw_tmrs[i + 1].handler_arg_ptr;
-               sw_tmrs[i].timer_id = sw_tmrs[i + 1].timer_id;
-               sw_tmrs[i].num_ticks = sw_tmrs[i + 1].num_ticks;
-          }
+          queue_copy_item(&(trace_ring[(index + n) & (AEDEA_OPT_TRACE_SIZE - 1)]), out_ptr, sizeof(trace_rec_t));
+          out_ptr += sizeof(trace_rec_t);
      }
-     
-     // If the deleted timer was expired, the active_tmrs_index index needs to
-     // be adjusted.
-     if(n < active_tmrs_index)
+
+     TRACE_UNLOCK();
+     trace_quiet--;
+
+     return TRACE_DUMP_HDR_SIZE + (num_recs * sizeof(trace_rec_t));
+}
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
+/*
+ * ----- Function: aedea_trace_clear() -----
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+void aedea_trace_clear(void)
+{
+     trace_quiet++;
+     TRACE_LOCK();
+
+     trace_count = 0;
+     trace_lost = 0;
+
+     TRACE_UNLOCK();
+     trace_quiet--;
+}
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
+/*
+ * ----- Function: trace_record() -----
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+static void trace_record(uint8_t type, uint8_t id, port_uint_t arg)
+{
+     if(0 == (trace_mask & ((port_uint_t)1 << type)))
      {
-          active_tmrs_index--;
+          return;
      }
-     
-     AEDEA_EXIT_CRITICAL_SECTION();
 
-     return TRUE;
+     // Records are written with the timer and queue locks held, so the ring is locked
+     // with its leaf lock. The recorder's own critical section is not recorded.
+     trace_quiet++;
+     TRACE_LOCK();
+
+     trace_write(type, id, arg);
+
+     TRACE_UNLOCK();
+     trace_quiet--;
 }
-#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
 
 
 /*
- * ----- Function: aedea_post_event() -----
+ * ----- Function: trace_write() -----
  */
-bool_t aedea_post_event(port_uint_t pid, void * evt_item_ptr)
+#if(AEDEA_OPT_USE_TRACE == 1)
+static void trace_write(uint8_t type, uint8_t id, port_uint_t arg)
 {
-     proc_mgr_t * proc_mgr_ptr;    // Used to store the pointer to the process manager for the process with the specified process ID.
-     port_uint_t n = 0;
-     
-     // Search for the process with the specified process ID.
-     proc_mgr_ptr = NULL;
-     for(n = 0; n < AEDEA_OPT_MAX_PROCESSES; n++)
+     trace_rec_t * rec_ptr;   // Record to be written.
+
+     // Must be called with the trace ring locked, the oldest record is overwritten
+     // if the ring is full.
+     rec_ptr = &(trace_ring[trace_head & (AEDEA_OPT_TRACE_SIZE - 1)]);
+     rec_ptr->time = PORT_CYCLES();
+     rec_ptr->arg = arg;
+     rec_ptr->type = type;
+     rec_ptr->id = id;
+
+     trace_head++;
+     if(trace_count < AEDEA_OPT_TRACE_SIZE)
      {
-          if(proc_mgrs[n].pid == pid)
-          {
-               proc_mgr_ptr = &(proc_mgrs[n]);
-               break;
-          }
+          trace_count++;
      }
-     
-     // Return FALSE if a process with the specified ID was not found.
-     if(NULL == proc_mgr_ptr)
+     else
      {
-          return FALSE;
+          trace_lost++;
      }
-
-     // Push the new event item on to the event queue.
-     return queue_push_item(&(proc_mgr_ptr->event_queue), evt_item_ptr);
 }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
 
 
 /*
- * ----- Function: aedea_get_event() -----
+ * ----- Function: trace_write_cs() -----
  */
-bool_t aedea_get_event(void * evt_item_ptr)
+#if(AEDEA_OPT_USE_TRACE == 1)
+static void trace_write_cs(uint8_t type, port_uint_t arg)
 {
-     // Pop an event item on from the event queue.
-     return queue_pop_item(&(active_proc_mgr->event_queue), evt_item_ptr);
+     // Called by aedea_critical_nesting() with interrupts locked, which is the trace ring's
+     // lock unless fine grained locks are used.
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+     PORT_LOCK_TAKE(&trace_lock);
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
+
+     trace_write(type, 0, arg);
+
+#if(AEDEA_OPT_USE_FINE_LOCKS == 1)
+     PORT_LOCK_GIVE(&trace_lock);
+#endif    /* (AEDEA_OPT_USE_FINE_LOCKS == 1) */
 }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
 
 
 /*
  * ----- Function: aedea_critical_nesting() -----
  */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
 void aedea_critical_nesting(uint8_t mode)
 {
-     static port_uint_t nesting_level = 0;        // Stores the critical section nesting level.
+     aedea_critical_nesting_at(mode, NULL, 0);
+}
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*
+ * ----- Function: aedea_critical_nesting_at() -----
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+void aedea_critical_nesting_at(uint8_t mode, const char * file_ptr, port_uint_t line)
+#else
+void aedea_critical_nesting(uint8_t mode)
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+{
+     static PORT_THREAD_LOCAL port_uint_t nesting_level = 0;     // Stores the critical section nesting level.
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+     static PORT_THREAD_LOCAL port_uint_t start_cycles;          // Cycle count when the outermost critical section was entered.
+     static PORT_THREAD_LOCAL const char * start_file_ptr;       // Source file which entered the outermost critical section.
+     static PORT_THREAD_LOCAL port_uint_t start_line;            // Source line which entered the outermost critical section.
+     port_uint_t cycles;                                         // Duration of the critical section.
+     port_uint_t limit;                                          // Upper limit of a histogram bucket.
+     port_uint_t n;
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
      
      // Critical section start.
      if(AEDEA_CRITICAL_SECTION_START == mode)
      {
-          // Lock interrupts and increment the nesting level.
-          PORT_LOCK_INTERRUPTS();
+          // Lock interrupts when entering the outermost critical section (the port's lock
+          // need not be recursive) and increment the nesting level.
+          if(0 == nesting_level)
+          {
+               PORT_LOCK_INTERRUPTS();
+
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+               start_file_ptr = file_ptr;
+               start_line = line;
+               start_cycles = PORT_CYCLES();
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+               PROBE2(cs_enter, file_ptr, line);
+#else
+               PROBE2(cs_enter, NULL, 0);
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+               if((0 == trace_quiet) && (0 != (trace_mask & ((port_uint_t)1 << AEDEA_TRACE_CS_ENTER))))
+               {
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+                    trace_write_cs(AEDEA_TRACE_CS_ENTER, line);
+#else
+                    trace_write_cs(AEDEA_TRACE_CS_ENTER, 0);
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+               }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+          }
           nesting_level++;
      }
      // Critical section end.
@@ -624,12 +3754,112 @@ void aedea_critical_nesting(uint8_t mode)
           // If nesting level is zero, unlock interrupts.
           if(0 == nesting_level)
           {
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+               // Account for the critical section while interrupts are still locked.
+               cycles = PORT_CYCLES() - start_cycles;
+
+               cs_prof.count++;
+               if(cycles > cs_prof.max_cycles)
+               {
+                    cs_prof.max_cycles = cycles;
+                    cs_prof.max_file_ptr = start_file_ptr;
+                    cs_prof.max_line = start_line;
+               }
+
+               limit = (port_uint_t)1 << AEDEA_OPT_CS_PROF_SHIFT;
+               for(n = 0; (n < (AEDEA_OPT_CS_PROF_BUCKETS - 1)) && (cycles >= limit); n++)
+               {
+                    limit <<= 1;
+               }
+               cs_prof.hist[n]++;
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+               if((0 == trace_quiet) && (0 != (trace_mask & ((port_uint_t)1 << AEDEA_TRACE_CS_EXIT))))
+               {
+                    trace_write_cs(AEDEA_TRACE_CS_EXIT, 0);
+               }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+               PROBE0(cs_exit);
+
                PORT_UNLOCK_INTERRUPTS();
           }
      }
 }
 
 
+/*
+ * ----- Function: aedea_get_cs_profile() -----
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+void aedea_get_cs_profile(aedea_cs_prof_t * prof_ptr)
+{
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     *prof_ptr = cs_prof;
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+}
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*
+ * ----- Function: aedea_reset_cs_profile() -----
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+void aedea_reset_cs_profile(void)
+{
+     port_uint_t n;
+
+     AEDEA_ENTER_CRITICAL_SECTION();
+
+     cs_prof.count = 0;
+     cs_prof.max_cycles = 0;
+     cs_prof.max_file_ptr = NULL;
+     cs_prof.max_line = 0;
+     for(n = 0; n < AEDEA_OPT_CS_PROF_BUCKETS; n++)
+     {
+          cs_prof.hist[n] = 0;
+     }
+
+     AEDEA_EXIT_CRITICAL_SECTION();
+}
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*
+ * ----- Function: tmr_lock_nesting() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_FINE_LOCKS == 1))
+static void tmr_lock_nesting(uint8_t mode)
+{
+     static PORT_THREAD_LOCAL port_uint_t nesting_level = 0;     // Stores the timer lock nesting level.
+
+     // The timer lock is taken again by timer functions called with the lock held
+     // (e.g. from a hard timer's handler), only the outermost level takes and gives
+     // the port's lock.
+     if(AEDEA_CRITICAL_SECTION_START == mode)
+     {
+          if(0 == nesting_level)
+          {
+               PORT_LOCK_TAKE(&tmr_lock);
+          }
+          nesting_level++;
+     }
+     else if(AEDEA_CRITICAL_SECTION_END == mode)
+     {
+          nesting_level--;
+
+          if(0 == nesting_level)
+          {
+               PORT_LOCK_GIVE(&tmr_lock);
+          }
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_FINE_LOCKS == 1)) */
+
+
  /*
  * ----- Function: queue_push_item() -----
  */
@@ -637,13 +3867,19 @@ static bool_t queue_push_item(queue_t * queue_ptr, const void * item_ptr)
 {
      void * empty_slot_ptr;        // Used to store the empty slot pointer.
 
-     // If there is no space availabe in the event queue, return FALSE.
+     QUEUE_LOCK(queue_ptr);
+
+     // If there is no space availabe in the event queue, return FALSE. The check is
+     // made under the lock, two posters could otherwise both take the last slot.
      if(queue_ptr->count == queue_ptr->num_items)
      {
+#if(AEDEA_OPT_USE_METRICS == 1)
+          queue_ptr->num_dropped++;
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+          PROBE2(queue_full, queue_ptr, queue_ptr->num_items);
+          QUEUE_UNLOCK(queue_ptr);
           return FALSE;
      }
-     
-     AEDEA_ENTER_CRITICAL_SECTION();
 
      // Store the pointer to the empty item slot.
      empty_slot_ptr = (port_uint_t *)((queue_ptr->head * queue_ptr->item_size) + (uint8_t *)queue_ptr->buff_ptr);
@@ -651,13 +3887,40 @@ static bool_t queue_push_item(queue_t * queue_ptr, const void * item_ptr)
      // Copy the item on to the queue.
      queue_copy_item(item_ptr, empty_slot_ptr, queue_ptr->item_size);
 
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     // Stamp the item with the current tick if a TTL is set.
+     if(NULL != queue_ptr->stamp_ptr)
+     {
+          queue_ptr->stamp_ptr[queue_ptr->head] = tick_count;
+     }
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     // Stamp the item with the cycle count if its latency is measured.
+     if(NULL != queue_ptr->lat_stamp_ptr)
+     {
+          queue_ptr->lat_stamp_ptr[queue_ptr->head] = PORT_CYCLES();
+     }
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+     // Recorded under the queue lock, so that the record precedes the item's GET.
+     if(TRUE == queue_ptr->traced)
+     {
+          trace_record(AEDEA_TRACE_POST, queue_ptr->trace_id, queue_ptr->trace_seq);
+          queue_ptr->trace_seq++;
+     }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
      // Increment the head pointer.
      queue_ptr->head = (queue_ptr->head + 1) % queue_ptr->num_items;
 
      // Increment the item count.
      queue_ptr->count++;
+
+     PROBE2(queue_push, queue_ptr, queue_ptr->count);
      
-     AEDEA_EXIT_CRITICAL_SECTION();
+     QUEUE_UNLOCK(queue_ptr);
      
      return TRUE;
 }
@@ -669,14 +3932,45 @@ static bool_t queue_push_item(queue_t * queue_ptr, const void * item_ptr)
 static bool_t queue_pop_item(queue_t * queue_ptr,  void * item_ptr)
 {
      void * pop_item_ptr;     // Pointer to the item to be popped off the queue.
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     port_uint_t latency;     // Time the item spent in the queue.
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+     QUEUE_LOCK(queue_ptr);
 
      // If no un-popped item is present, return FALSE.
      if(0 == queue_ptr->count)
      {
+          QUEUE_UNLOCK(queue_ptr);
           return FALSE;
      }
-     
-     AEDEA_ENTER_CRITICAL_SECTION();
+
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     // Discard items which have outlived the TTL without copying them.
+     if(NULL != queue_ptr->stamp_ptr)
+     {
+          while((0 != queue_ptr->count) &&
+                ((port_uint_t)(tick_count - queue_ptr->stamp_ptr[queue_ptr->tail]) > queue_ptr->ttl))
+          {
+#if(AEDEA_OPT_USE_TRACE == 1)
+               if(TRUE == queue_ptr->traced)
+               {
+                    trace_record(AEDEA_TRACE_DISCARD, queue_ptr->trace_id, queue_ptr->trace_seq - queue_ptr->count);
+               }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+               queue_ptr->tail = (queue_ptr->tail + 1) % queue_ptr->num_items;
+               queue_ptr->count--;
+               queue_ptr->num_expired++;
+          }
+
+          // Return FALSE if all items were discarded.
+          if(0 == queue_ptr->count)
+          {
+               QUEUE_UNLOCK(queue_ptr);
+               return FALSE;
+          }
+     }
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
 
      // Get a pointer to the item to be popped off the queue.
      pop_item_ptr = (port_uint_t *)((queue_ptr->tail * queue_ptr->item_size) + (uint8_t *)queue_ptr->buff_ptr);
@@ -684,13 +3978,39 @@ static bool_t queue_pop_item(queue_t * queue_ptr,  void * item_ptr)
      // Copy item from the queue.
      queue_copy_item(pop_item_ptr, item_ptr, queue_ptr->item_size);
 
+#if((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1))
+     queue_ptr->num_popped++;
+#endif    /* ((AEDEA_OPT_USE_PROC_STATS == 1) || (AEDEA_OPT_USE_SCHED_STATS == 1)) */
+
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     // Account for the time the item spent in the queue.
+     if(NULL != queue_ptr->lat_stamp_ptr)
+     {
+          latency = PORT_CYCLES() - queue_ptr->lat_stamp_ptr[queue_ptr->tail];
+          queue_ptr->num_timed++;
+          queue_ptr->total_latency += latency;
+          if(latency > queue_ptr->max_latency)
+          {
+               queue_ptr->max_latency = latency;
+          }
+     }
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+#if(AEDEA_OPT_USE_TRACE == 1)
+     // The queue is FIFO, the sequence number of the oldest item follows from the count.
+     if(TRUE == queue_ptr->traced)
+     {
+          trace_record(AEDEA_TRACE_GET, queue_ptr->trace_id, queue_ptr->trace_seq - queue_ptr->count);
+     }
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
      // Increment the tail pointer.
      queue_ptr->tail = (queue_ptr->tail + 1) % queue_ptr->num_items;
 
      // Decrement the item count.
      queue_ptr->count--;
      
-     AEDEA_EXIT_CRITICAL_SECTION();
+     QUEUE_UNLOCK(queue_ptr);
 
      return TRUE;
 }
@@ -711,5 +4031,25 @@ static void queue_copy_item(const void * src_ptr, void * dest_ptr, port_uint_t i
 }
 
 
+/*
+ * ----- Function: find_proc_mgr() -----
+ */
+static proc_mgr_t * find_proc_mgr(uint8_t pid)
+{
+     port_uint_t n = 0;
+
+     // Search for the process with the specified process ID.
+     for(n = 0; n < num_processes; n++)
+     {
+          if(proc_mgrs[n].pid == pid)
+          {
+               return &(proc_mgrs[n]);
+          }
+     }
+
+     return NULL;
+}
+
+
 /*----------------------------------------------------------------------------*/
 /*! @} */
@@ -77,7 +77,11 @@
  *
  * \hideinitializer
  */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+#define AEDEA_ENTER_CRITICAL_SECTION()  aedea_critical_nesting_at(AEDEA_CRITICAL_SECTION_START, __FILE__, __LINE__)
+#else
 #define AEDEA_ENTER_CRITICAL_SECTION()  aedea_critical_nesting(AEDEA_CRITICAL_SECTION_START)
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
 
 
 /*!
@@ -85,7 +89,11 @@
  *
  * \hideinitializer
  */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+#define AEDEA_EXIT_CRITICAL_SECTION()   aedea_critical_nesting_at(AEDEA_CRITICAL_SECTION_END, __FILE__, __LINE__)
+#else
 #define AEDEA_EXIT_CRITICAL_SECTION()   aedea_critical_nesting(AEDEA_CRITICAL_SECTION_END)
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
 
 
 /*!
@@ -107,6 +115,79 @@
 #define AEDEA_EXIT_ISR()      AEDEA_EXIT_CRITICAL_SECTION()
 
 
+/*!
+ * Timer flag for one-shot timers, the timer expires once and stays installed until it is
+ * re-armed or deleted.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_TMR_ONE_SHOT    0x00
+
+
+/*!
+ * Timer flag for periodic (auto-reload) timers, the timer is re-armed with its timeout value
+ * each time it expires. The timer is re-armed relative to the tick it was due on, not to the
+ * time the timeout handler is called, so the period does not drift.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_TMR_PERIODIC    0x01
+
+
+/*!
+ * Timer flag for the nanosecond timer API, the time value is an absolute aedea_now() deadline
+ * instead of a timeout relative to the current time. Cannot be combined with AEDEA_TMR_PERIODIC.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_TMR_ABS_TIME    0x02
+
+
+/*!
+ * Timer flag for hard timers, the timeout handler is called directly from aedea_timer_tick()
+ * (with interrupts locked) instead of the timer process, for actions which cannot wait for the
+ * timer process to be scheduled. The handler must be short and may only use AEDEA API calls
+ * which are safe in an ISR. Can be combined with AEDEA_TMR_PERIODIC.
+ *
+ * \hideinitializer
+ * \note Only available if AEDEA_OPT_USE_HARD_TMRS is set to 1, otherwise timers installed with
+ * this flag are rejected.
+ */
+#define AEDEA_TMR_HARD        0x04
+
+
+/*!
+ * Group ID used to remove a timer from its group with aedea_set_timer_group().
+ *
+ * \hideinitializer
+ */
+#define AEDEA_TMR_NO_GROUP    0xFF
+
+
+/*!
+ * Value returned by aedea_next_expiry() if no timer is running.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_TMR_NO_EXPIRY   ((port_uint_t)~0)
+
+
+/*!
+ * Trace record types, also used as bit numbers of the trace mask (see aedea_set_trace_mask()).
+ *
+ * \hideinitializer
+ */
+#define AEDEA_TRACE_POST           0    //!< Event posted, ID is the destination process, the argument the event's sequence number in its queue.
+#define AEDEA_TRACE_GET            1    //!< Event got, ID is the process, the argument the event's sequence number.
+#define AEDEA_TRACE_DISPATCH_START 2    //!< Process callback called, ID is the process.
+#define AEDEA_TRACE_DISPATCH_END   3    //!< Process callback returned, ID is the process.
+#define AEDEA_TRACE_TMR_INSTALL    4    //!< Timer installed, ID is the timer ID, the argument the timeout.
+#define AEDEA_TRACE_TMR_EXPIRE     5    //!< Timer expired, ID is the timer ID.
+#define AEDEA_TRACE_CS_ENTER       6    //!< Outermost critical section entered, the argument is the source line if the profiler is enabled.
+#define AEDEA_TRACE_CS_EXIT        7    //!< Outermost critical section left.
+#define AEDEA_TRACE_DISCARD        8    //!< Event discarded because its TTL expired, ID is the process, the argument the event's sequence number.
+
+
 /*
  * Process callback function type definition.
  */
@@ -119,6 +200,168 @@ typedef void process_callback_t(void *);          //!< Defines the prototype a p
 typedef void timeout_handler_t(uint8_t, void *);  //!< Defines the prototype a timeout handler should follow.
 
 
+/*!
+ * Software timer handle.
+ *
+ * Returned by aedea_install_timer() and used to re-arm or cancel the timer in constant
+ * time. A handle becomes stale once its timer is cancelled or deleted, stale handles are
+ * detected and rejected. The members are internal to AEDEA.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+typedef struct
+{
+     port_uint_t slot;                       //!< Index of the timer in AEDEA's timer pool.
+     port_uint_t gen;                        //!< Generation of the timer when the handle was issued.
+}
+aedea_tmr_handle_t;
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*!
+ * Scheduler loop statistics, filled in by aedea_get_sched_stats(). Times are in PORT_CYCLES()
+ * units. Each pass of the scheduler loop is counted in exactly one of busy_calls, empty_calls,
+ * delayed_passes and disabled_passes.
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+typedef struct
+{
+     unsigned long busy_calls;               //!< Process calls in which the process got at least one event.
+     unsigned long empty_calls;              //!< Process calls in which the process did not get any event.
+     unsigned long delayed_passes;           //!< Passes which only counted down the execution delay of a process.
+     unsigned long disabled_passes;          //!< Passes which skipped a disabled process.
+     unsigned long busy_cycles;              //!< Time spent in busy calls.
+     unsigned long idle_cycles;              //!< Time spent in all other passes.
+     port_uint_t utilisation;                //!< Percentage of time spent in busy calls during the last AEDEA_OPT_SCHED_WINDOW passes.
+}
+aedea_sched_stats_t;
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*!
+ * Metrics of a process and its event queue, part of aedea_metrics_t.
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+typedef struct
+{
+     uint8_t pid;                            //!< Process ID.
+     port_uint_t queue_depth;                //!< Number of events in the event queue.
+     port_uint_t queue_size;                 //!< Capacity of the event queue.
+     port_uint_t num_dropped;                //!< Number of events which could not be posted because the queue was full.
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     port_uint_t num_expired;                //!< Number of events discarded because their TTL expired.
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     port_uint_t invocations;                //!< Number of times the process callback was called.
+     port_uint_t empty_invocations;          //!< Number of calls in which the process did not get any event.
+     unsigned long total_cycles;             //!< Time spent in the process callback.
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+}
+aedea_proc_metrics_t;
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*!
+ * Metrics block, filled in by aedea_read_metrics().
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+typedef struct
+{
+     port_uint_t generation;                                     //!< Number of times the block was published.
+     port_uint_t num_processes;                                  //!< Number of valid entries in procs.
+     aedea_proc_metrics_t procs[AEDEA_OPT_MAX_PROCESSES + 1];    //!< Metrics of each process ("+ 1" for the timer process).
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+     port_uint_t tick_count;                                     //!< Number of timer ticks since initialization (wraps around).
+     port_uint_t num_timers;                                     //!< Number of installed timers.
+     port_uint_t num_pending_timers;                             //!< Number of expired timers waiting for the timer process.
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+     aedea_sched_stats_t sched;                                  //!< Scheduler loop statistics.
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+}
+aedea_metrics_t;
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*!
+ * Traffic matrix entry, filled in by aedea_get_traffic().
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+typedef struct
+{
+     bool_t external;                        //!< TRUE for posts from outside of a process callback.
+     uint8_t src_pid;                        //!< Posting process, zero if external is TRUE.
+     uint8_t dst_pid;                        //!< Receiving process.
+     port_uint_t count;                      //!< Number of events posted.
+     unsigned long bytes;                    //!< Number of bytes posted.
+}
+aedea_traffic_t;
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*!
+ * Timer lateness metrics, filled in by aedea_get_timer_lateness() and
+ * aedea_get_global_lateness(). Lateness is the number of ticks between the expiry of a timer
+ * and the call of its timeout handler by the timer process.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+typedef struct
+{
+     port_uint_t count;                                //!< Number of handler calls measured.
+     port_uint_t max;                                  //!< Largest lateness.
+     unsigned long total;                              //!< Sum of the lateness of all measured calls.
+     port_uint_t missed;                               //!< Number of missed periods.
+     port_uint_t hist[AEDEA_OPT_TMR_LATE_BUCKETS];     //!< Lateness histogram, see AEDEA_OPT_TMR_LATE_BUCKETS.
+}
+aedea_tmr_late_t;
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*!
+ * Nanosecond time type, as returned by aedea_now(). Wraps around, compare times by the sign
+ * of their difference.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+typedef uint64_t aedea_time_t;
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*!
+ * Critical section profile, filled in by aedea_get_cs_profile(). Durations are in
+ * PORT_CYCLES() units.
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+typedef struct
+{
+     port_uint_t count;                                //!< Number of critical sections measured.
+     port_uint_t max_cycles;                           //!< Longest critical section.
+     const char * max_file_ptr;                        //!< Source file of the AEDEA_ENTER_CRITICAL_SECTION() which started the longest critical section.
+     port_uint_t max_line;                             //!< Source line of the AEDEA_ENTER_CRITICAL_SECTION() which started the longest critical section.
+     port_uint_t hist[AEDEA_OPT_CS_PROF_BUCKETS];      //!< Duration histogram, see AEDEA_OPT_CS_PROF_BUCKETS.
+}
+aedea_cs_prof_t;
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*!
+ * Process runtime statistics, filled in by aedea_get_proc_stats(). Times are in PORT_CYCLES()
+ * units.
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+typedef struct
+{
+     port_uint_t invocations;                //!< Number of times the process callback was called.
+     port_uint_t empty_invocations;          //!< Number of calls in which the process did not get any event.
+     unsigned long total_cycles;             //!< Time spent in the process callback.
+     port_uint_t max_cycles;                 //!< Longest process callback call.
+     port_uint_t num_events;                 //!< Number of events the process got from its event queue.
+     port_uint_t num_timed;                  //!< Number of those events whose queueing latency was measured.
+     unsigned long total_latency;            //!< Sum of the measured queueing latencies (post to get).
+     port_uint_t max_latency;                //!< Longest measured queueing latency.
+}
+aedea_proc_stats_t;
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
 /*
  * AEDEA API prototypes.
  */
@@ -198,6 +441,27 @@ bool_t aedea_add_process(
 bool_t aedea_post_event(port_uint_t pid, void * evt_item_ptr);
 
 
+/*!
+ * Post an event to a process after the specified number of ticks. The event item is copied
+ * into an internal pool when this function is called and pushed on to the process' event
+ * queue directly from the timer tick on expiry, no software timer or timeout handler is used.
+ * If the process' event queue is full on expiry, the event is dropped.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param pid Process ID.
+ * \param evt_item_ptr Pointer to the event item.
+ * \param num_ticks Number of ticks after which to post the event, zero posts it immediately.
+ *
+ * \return TRUE if the event was successfully scheduled, FALSE otherwise.
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+bool_t aedea_post_event_after(port_uint_t pid, void * evt_item_ptr, port_uint_t num_ticks);
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
 /*!
  * Used by a process to get a single event from its event queue.
  *
@@ -212,6 +476,146 @@ bool_t aedea_post_event(port_uint_t pid, void * evt_item_ptr);
 bool_t aedea_get_event(void * evt_item_ptr);
 
 
+/*!
+ * Set the time-to-live (TTL) for events posted to a process. Each event posted to the process
+ * is stamped with the current timer tick, events which have been in the queue for more than
+ * ttl_ticks ticks are discarded by aedea_get_event() and counted instead of being returned.
+ *
+ * The stamp buffer must be able to hold one stamp for each event in the process' event queue
+ * (i.e. evt_queue_size entries, as passed to aedea_add_process()).
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param pid Process ID.
+ * \param ttl_ticks Maximum age of an event in ticks, zero disables the TTL.
+ * \param stamp_buff_ptr Pointer to the stamp buffer.
+ *
+ * \return TRUE if the TTL was successfully set, FALSE otherwise.
+ */
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+bool_t aedea_set_event_ttl(uint8_t pid, port_uint_t ttl_ticks, port_uint_t * stamp_buff_ptr);
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+
+/*!
+ * Get the number of events discarded because their TTL expired.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param pid Process ID.
+ *
+ * \return Number of expired events discarded for the process.
+ */
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+port_uint_t aedea_get_expired_event_count(uint8_t pid);
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+
+/*!
+ * Set the latency stamp buffer of a process. Each event posted to the process is stamped with
+ * PORT_CYCLES() and the time it spent in the event queue is accounted when the process gets
+ * it.
+ *
+ * The stamp buffer must be able to hold one stamp for each event in the process' event queue
+ * (i.e. evt_queue_size entries, as passed to aedea_add_process()).
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param pid Process ID.
+ * \param stamp_buff_ptr Pointer to the stamp buffer, NULL stops measuring the latency.
+ *
+ * \return TRUE if the buffer was successfully set, FALSE otherwise.
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+bool_t aedea_set_latency_buffer(uint8_t pid, port_uint_t * stamp_buff_ptr);
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*!
+ * Get a snapshot of the runtime statistics of a process.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param pid Process ID.
+ * \param stats_ptr Pointer to the structure to copy the statistics to.
+ *
+ * \return TRUE if the statistics were copied, FALSE if the process was not found.
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+bool_t aedea_get_proc_stats(uint8_t pid, aedea_proc_stats_t * stats_ptr);
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*!
+ * Clear the runtime statistics of a process.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param pid Process ID.
+ *
+ * \return TRUE if the statistics were cleared, FALSE if the process was not found.
+ */
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+bool_t aedea_reset_proc_stats(uint8_t pid);
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+
+/*!
+ * Select the trace record types to be recorded, all types are recorded by default.
+ *
+ * Usage:
+ * \code
+ * aedea_set_trace_mask((1 << AEDEA_TRACE_POST) | (1 << AEDEA_TRACE_GET));
+ * \endcode
+ *
+ * \param mask Bit mask of the record types, bit n enables AEDEA_TRACE_* type n.
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+void aedea_set_trace_mask(port_uint_t mask);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
+/*!
+ * Copy the trace ring, oldest record first, into a buffer in the format read by
+ * tools/aedea_trace2json.c. If the buffer is too small, the newest records which fit are
+ * copied. The ring is not cleared, it is locked while it is copied.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param buff_ptr Pointer to the buffer.
+ * \param buff_size Size of the buffer in bytes.
+ *
+ * \return Number of bytes written to the buffer.
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+port_uint_t aedea_trace_dump(void * buff_ptr, port_uint_t buff_size);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
+/*!
+ * Discard all records in the trace ring.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+void aedea_trace_clear(void);
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
 /*!
  * Install a timeout handler.
  *
@@ -222,7 +626,8 @@ bool_t aedea_get_event(void * evt_item_ptr);
  * \param handler Timeout handler function.
  * \param handler_arg_ptr Pointer to the argument to be passed to the timeout handler.
  * \param timer_id Integer value used to identify this timer.
- * \param num_ticks Number of ticks after which to timeout.
+ * \param num_ticks Number of ticks after which to timeout (and the period of a periodic timer).
+ * \param flags AEDEA_TMR_ONE_SHOT or AEDEA_TMR_PERIODIC, optionally AEDEA_TMR_HARD.
  *
  * \return TRUE if the timeuot handler was successfully installed, FALSE otherwise.
  */
@@ -231,13 +636,15 @@ bool_t aedea_install_timeout_handler(
                                      timeout_handler_t * handler,
                                      void * handler_arg_ptr,
                                      uint8_t timer_id,
-                                     port_uint_t num_ticks
+                                     port_uint_t num_ticks,
+                                     uint8_t flags
                                     );
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
 /*!
- * Refresh the timeout interval for a previously installed timeout handler.
+ * Refresh the timeout interval for a previously installed timeout handler. For a periodic
+ * timer, the new timeout interval also becomes the timer's period.
  *
  * Usage:
  * \code
@@ -269,14 +676,530 @@ bool_t aedea_delete_timer(uint8_t timer_id);
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
+/*!
+ * Install a timeout handler and return a handle to it.
+ *
+ * Unlike timers installed with aedea_install_timeout_handler(), timers installed with this
+ * function are not looked up by their timer ID: the ID is only passed to the timeout handler
+ * and need not be unique. The timer stays installed after it expires and can be re-armed
+ * with aedea_rearm_timer() until it is cancelled with aedea_cancel_timer().
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle_ptr Pointer used to return the timer's handle.
+ * \param handler Timeout handler function.
+ * \param handler_arg_ptr Pointer to the argument to be passed to the timeout handler.
+ * \param timer_id Integer value passed to the timeout handler.
+ * \param num_ticks Number of ticks after which to timeout (and the period of a periodic timer).
+ * \param flags AEDEA_TMR_ONE_SHOT or AEDEA_TMR_PERIODIC, optionally AEDEA_TMR_HARD.
+ *
+ * \return TRUE if the timeout handler was successfully installed, FALSE otherwise.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_install_timer(
+                           aedea_tmr_handle_t * handle_ptr,
+                           timeout_handler_t * handler,
+                           void * handler_arg_ptr,
+                           uint8_t timer_id,
+                           port_uint_t num_ticks,
+                           uint8_t flags
+                          );
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*!
+ * Re-arm a timer with a new timeout value. An expiry of the timer which is still waiting
+ * for its timeout handler to be called is cancelled. For a periodic timer, the new timeout
+ * value also becomes the timer's period.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ * \param num_ticks Number of ticks after which to timeout.
+ *
+ * \return TRUE if the timer was successfully re-armed, FALSE if the handle is stale.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_rearm_timer(aedea_tmr_handle_t handle, port_uint_t num_ticks);
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*!
+ * Cancel a timer and release it. An expiry of the timer which is still waiting for its
+ * timeout handler to be called is cancelled, the handle becomes stale.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ *
+ * \return TRUE if the timer was successfully cancelled, FALSE if the handle is stale.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+bool_t aedea_cancel_timer(aedea_tmr_handle_t handle);
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*!
+ * Bind a timer to a process. Each time the timer expires, the event item is posted to the
+ * process from the timer tick and the timer's timeout handler is not called. The timer's
+ * work is then done by its process, with the process' own scheduling, and a slow handler
+ * does not delay the timeout handlers of other timers.
+ *
+ * The event item is posted by reference, it must remain valid while the timer is bound and
+ * be at least as large as the process' event items. An expiry is lost if the process' event
+ * queue is full.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ * \param pid ID of the process to post the event to.
+ * \param evt_item_ptr Pointer to the event item to post, NULL to unbind the timer and call
+ * its timeout handler again.
+ *
+ * \return TRUE if the timer was successfully bound, FALSE if the handle is stale or there is
+ * no process with the specified ID.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_EVENTS == 1))
+bool_t aedea_bind_timer(aedea_tmr_handle_t handle, uint8_t pid, void * evt_item_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_EVENTS == 1)) */
+
+
+/*!
+ * Add a timer to a group, or move it to another group. All timers of a group can be cancelled
+ * at once with aedea_cancel_group(). A timer leaves its group when it is cancelled or deleted.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ * \param group Group ID (0 to AEDEA_OPT_MAX_TMR_GROUPS - 1), AEDEA_TMR_NO_GROUP to remove the
+ * timer from its group.
+ *
+ * \return TRUE if the group was successfully set, FALSE if the handle is stale or the group ID
+ * is invalid.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+bool_t aedea_set_timer_group(aedea_tmr_handle_t handle, uint8_t group);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*!
+ * Add a timer installed with aedea_install_timeout_handler() to a group, or move it to another
+ * group, as aedea_set_timer_group() does for timers installed with a handle.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param timer_id Timer ID of the timer.
+ * \param group Group ID (0 to AEDEA_OPT_MAX_TMR_GROUPS - 1), AEDEA_TMR_NO_GROUP to remove the
+ * timer from its group.
+ *
+ * \return TRUE if the group was successfully set, FALSE if no timer with the ID is installed
+ * or the group ID is invalid.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+bool_t aedea_set_timer_group_by_id(uint8_t timer_id, uint8_t group);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*!
+ * Cancel and release all timers of a group, in time proportional to the size of the group.
+ * Expiries of these timers which are still waiting for their timeout handlers to be called
+ * are cancelled and all their handles become stale.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param group Group ID.
+ *
+ * \return Number of cancelled timers.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+port_uint_t aedea_cancel_group(uint8_t group);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+
+/*!
+ * Submit the installation of a timeout handler to the timer command queue. The command has
+ * the same effect as aedea_install_timeout_handler() and is applied by the timer process,
+ * a failure to install the timeout handler is not reported.
+ *
+ * Like all aedea_submit_*() functions, this function does not lock interrupts and can be
+ * called from any thread (or ISR) concurrently with other submissions. Commands are applied
+ * in the order they were submitted.
+ *
+ * There is no submitted form of aedea_install_timer(): a command is applied after it was
+ * submitted, so there is no handle to return to the submitter. Timers which are re-armed or
+ * cancelled with aedea_submit_rearm() and aedea_submit_cancel() have to be installed with
+ * aedea_install_timer() (or aedea_install_timer_ns()) directly, typically once at start up.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handler Timeout handler function.
+ * \param handler_arg_ptr Pointer to the argument to be passed to the timeout handler.
+ * \param timer_id Integer value used to identify this timer.
+ * \param num_ticks Number of ticks after which to timeout (and the period of a periodic timer).
+ * \param flags Timer flags, as for aedea_install_timeout_handler().
+ *
+ * \return TRUE if the command was queued, FALSE if the command queue is full or the flags
+ * are not supported.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_install(
+                            timeout_handler_t * handler,
+                            void * handler_arg_ptr,
+                            uint8_t timer_id,
+                            port_uint_t num_ticks,
+                            uint8_t flags
+                           );
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*!
+ * Submit aedea_refresh_timer() to the timer command queue.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param timer_id ID of the timer to refresh.
+ * \param num_ticks Number of ticks after which to timeout.
+ *
+ * \return TRUE if the command was queued, FALSE if the command queue is full.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_refresh(uint8_t timer_id, port_uint_t num_ticks);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*!
+ * Submit aedea_delete_timer() to the timer command queue.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param timer_id ID of the timer to delete.
+ *
+ * \return TRUE if the command was queued, FALSE if the command queue is full.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_delete(uint8_t timer_id);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*!
+ * Submit aedea_rearm_timer() to the timer command queue, see aedea_submit_install() for how
+ * the timer is installed.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ * \param num_ticks Number of ticks after which to timeout.
+ *
+ * \return TRUE if the command was queued, FALSE if the command queue is full.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_rearm(aedea_tmr_handle_t handle, port_uint_t num_ticks);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*!
+ * Submit aedea_cancel_timer() to the timer command queue, see aedea_submit_install() for how
+ * the timer is installed.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ *
+ * \return TRUE if the command was queued, FALSE if the command queue is full.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+bool_t aedea_submit_cancel(aedea_tmr_handle_t handle);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+
+/*!
+ * Get a snapshot of the scheduler loop statistics. The statistics are published by the
+ * scheduler every AEDEA_OPT_SCHED_WINDOW passes, passes of the current window are not
+ * included yet.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param stats_ptr Pointer to the structure to copy the statistics to.
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+void aedea_get_sched_stats(aedea_sched_stats_t * stats_ptr);
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*!
+ * Clear the scheduler loop statistics.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+void aedea_reset_sched_stats(void);
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*!
+ * Copy the metrics block last published by the scheduler. The copy is consistent: if the
+ * scheduler publishes the block while it is being copied, the copy is retried. The scheduler
+ * is never blocked, so this can be called from any thread, but not from an ISR which
+ * interrupts the scheduler.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param metrics_ptr Pointer to the structure to copy the metrics to.
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+void aedea_read_metrics(aedea_metrics_t * metrics_ptr);
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*!
+ * Copy the non-empty entries of the traffic matrix. Only events which were actually queued
+ * are counted.
+ *
+ * Usage:
+ * \code
+ * aedea_traffic_t entries[16];
+ * port_uint_t n = aedea_get_traffic(entries, 16);
+ * \endcode
+ *
+ * \param entries_ptr Pointer to the array to copy the entries to.
+ * \param max_entries Number of entries in the array.
+ *
+ * \return Number of entries copied.
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+port_uint_t aedea_get_traffic(aedea_traffic_t * entries_ptr, port_uint_t max_entries);
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*!
+ * Clear the traffic matrix.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+void aedea_reset_traffic(void);
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*!
+ * Get the lateness metrics of a timer. The metrics are kept from the installation of the
+ * timer until it is deleted. Hard timers and timers bound to a process are not measured.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param timer_id ID of the timer.
+ * \param late_ptr Pointer to the structure to copy the metrics to.
+ *
+ * \return TRUE if the metrics were copied, FALSE if no timer with this ID is installed.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+bool_t aedea_get_timer_lateness(uint8_t timer_id, aedea_tmr_late_t * late_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*!
+ * Get the lateness metrics of all timers.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param late_ptr Pointer to the structure to copy the metrics to.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+void aedea_get_global_lateness(aedea_tmr_late_t * late_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*!
+ * Clear the lateness metrics of all timers and the global ones.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+void aedea_reset_lateness(void);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+
+/*!
+ * Set the slack of a timer, the number of ticks the timer may expire later than requested
+ * so that its expiry can be coalesced with those of other timers. The slack applies to the
+ * timer's current timeout (if it is running) and to all re-arms until it is changed. For
+ * periodic timers the slack should be smaller than the period, the period does not drift.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ * \param slack_ticks Slack in ticks, 0 for exact expiry.
+ *
+ * \return TRUE if the slack was successfully set, FALSE if the handle is stale.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1))
+bool_t aedea_set_timer_slack(aedea_tmr_handle_t handle, port_uint_t slack_ticks);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_SLACK == 1)) */
+
+
+/*!
+ * Get the current time of the port's monotonic clock.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \return Current time in nanoseconds.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+aedea_time_t aedea_now(void);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*!
+ * Install a timeout handler with a nanosecond timeout and return a handle to it.
+ *
+ * Works like aedea_install_timer(), but the timeout is measured with the port clock. The
+ * timer runs on the tick and is re-armed for the remainder if it fires before its deadline,
+ * so its handler is never called early. A periodic timer's deadlines are spaced exactly
+ * time_ns apart.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle_ptr Pointer used to return the timer's handle.
+ * \param handler Timeout handler function.
+ * \param handler_arg_ptr Pointer to the argument to be passed to the timeout handler.
+ * \param timer_id Integer value passed to the timeout handler.
+ * \param time_ns Timeout in nanoseconds (and the period of a periodic timer), or an absolute
+ * deadline if AEDEA_TMR_ABS_TIME is set.
+ * \param flags AEDEA_TMR_ONE_SHOT or AEDEA_TMR_PERIODIC, optionally AEDEA_TMR_HARD and
+ * AEDEA_TMR_ABS_TIME for one-shot timers.
+ *
+ * \return TRUE if the timeout handler was successfully installed, FALSE otherwise.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+bool_t aedea_install_timer_ns(
+                              aedea_tmr_handle_t * handle_ptr,
+                              timeout_handler_t * handler,
+                              void * handler_arg_ptr,
+                              uint8_t timer_id,
+                              aedea_time_t time_ns,
+                              uint8_t flags
+                             );
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
+/*!
+ * Re-arm a timer with a nanosecond timeout. An expiry of the timer which is still waiting
+ * for its timeout handler to be called is cancelled. A periodic timer stays periodic with
+ * time_ns as its new period.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param handle Handle of the timer.
+ * \param time_ns Timeout in nanoseconds, or an absolute deadline if AEDEA_TMR_ABS_TIME is set.
+ * \param flags 0 or AEDEA_TMR_ABS_TIME (one-shot timers only).
+ *
+ * \return TRUE if the timer was successfully re-armed, FALSE if the handle is stale or the
+ * flags are invalid for the timer.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+bool_t aedea_rearm_timer_ns(aedea_tmr_handle_t handle, aedea_time_t time_ns, uint8_t flags);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
 /*!
  * Timer tick handler, to be called from the system's timer ISR on each tick.
+ *
+ * If AEDEA_OPT_TMR_TICKLESS is set to 1, this function is called from the ISR of the one-shot
+ * timer programmed through PORT_TMR_SET_ONESHOT() instead. It credits all ticks reported by
+ * PORT_TMR_ELAPSED() in one step and programs the next deadline.
+ *
+ * If AEDEA_OPT_TMR_DEFERRED_TICK is set to 1, this function only counts the tick and the
+ * timer process does the rest of the work.
  */
 #if(AEDEA_OPT_USE_SOFT_TMR == 1)
 void aedea_timer_tick(void);
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
+/*!
+ * Advance the software timers by a number of ticks at once, e.g. after ticks were missed
+ * during a long critical section or on resume from sleep. All timers and delayed events due
+ * within those ticks expire in order, each on the tick it was due. The time taken is
+ * proportional to the number of expiries, not to the number of ticks.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param num_ticks Number of elapsed ticks.
+ *
+ * \note If AEDEA_OPT_TMR_TICKLESS is set to 1, num_ticks is ignored and the ticks which
+ * PORT_TMR_ELAPSED() reports are credited instead, as aedea_timer_tick() does. If
+ * AEDEA_OPT_TMR_DEFERRED_TICK is set to 1, the ticks are only counted and credited by the
+ * timer process.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+void aedea_timer_advance(port_uint_t num_ticks);
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*!
+ * Get the number of ticks until the next software timer expires or the next delayed event
+ * is due. For timers far in the future, an earlier tick on which the timers are
+ * re-organized may be returned.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \return Number of ticks until the next expiry, AEDEA_TMR_NO_EXPIRY if nothing is pending.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+port_uint_t aedea_next_expiry(void);
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
 /*!
  * Handles nested critical sections. This function should not be called directly, instead
  * the AEDEA_ENTER_CRITICAL_SECTION() and AEDEA_EXIT_CRITICAL_SECTION() macros should be
@@ -291,6 +1214,50 @@ void aedea_timer_tick(void);
 void aedea_critical_nesting(uint8_t mode);
 
 
+/*!
+ * Handles nested critical sections and profiles them. Used instead of
+ * aedea_critical_nesting() by the AEDEA_ENTER_CRITICAL_SECTION() and
+ * AEDEA_EXIT_CRITICAL_SECTION() macros if the critical section profiler is enabled.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param mode AEDEA_CRITICAL_SECTION_START or AEDEA_CRITICAL_SECTION_END.
+ * \param file_ptr Source file of the caller.
+ * \param line Source line of the caller.
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+void aedea_critical_nesting_at(uint8_t mode, const char * file_ptr, port_uint_t line);
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*!
+ * Get a copy of the critical section profile.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ *
+ * \param prof_ptr Pointer to the structure to copy the profile to.
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+void aedea_get_cs_profile(aedea_cs_prof_t * prof_ptr);
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*!
+ * Clear the critical section profile.
+ *
+ * Usage:
+ * \code
+ * \endcode
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+void aedea_reset_cs_profile(void);
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
 #endif    /* __AEDEA_H */
 
 
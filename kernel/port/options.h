@@ -89,6 +89,224 @@
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
+/*!
+ * Set to 1 to use a hierarchical timing wheel for the software timers instead of the
+ * delta list.
+ *
+ * The delta list keeps running timers sorted by timeout, arming a timer walks the list
+ * (O(n)) while each tick only touches the first timer. The timing wheel arms, deletes and
+ * ticks in constant time regardless of the number of running timers and should be used
+ * when a large number of timers is required.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_TMR_WHEEL    0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+
+/*!
+ * Number of bits per timing wheel level, each level has 2^AEDEA_OPT_TMR_WHEEL_BITS slots.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_TMR_WHEEL is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+#define AEDEA_OPT_TMR_WHEEL_BITS   5
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*!
+ * Number of timing wheel levels.
+ *
+ * The wheel directly covers timeouts of up to 2^(AEDEA_OPT_TMR_WHEEL_BITS * AEDEA_OPT_TMR_WHEEL_LEVELS)
+ * ticks, longer timeouts are re-cascaded through the top level. The product must be less
+ * than the width of port_uint_t (e.g. 5 x 3 for 16-bit, 6 x 5 for 32-bit platforms).
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_TMR_WHEEL is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1))
+#define AEDEA_OPT_TMR_WHEEL_LEVELS 3
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_WHEEL == 1)) */
+
+
+/*!
+ * Set to 1 to run the software timers without a periodic tick.
+ *
+ * In tickless mode the kernel programs a one-shot deadline for the next expiry through
+ * PORT_TMR_SET_ONESHOT() and aedea_timer_tick() is called from the one-shot timer's ISR,
+ * crediting all ticks reported by PORT_TMR_ELAPSED() at once. Both hooks have to be defined
+ * in platform.h. Since the tick no longer causes wake-ups, it can be made much shorter than
+ * a periodic tick could be.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_TMR_TICKLESS     0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Set to 1 to defer all timer work from the tick ISR to the timer process.
+ *
+ * aedea_timer_tick() then only counts the tick, the timer process expires the due timers
+ * when it runs next. The time spent in the tick ISR is short and constant, however many
+ * timers expire on the same tick, at the cost of timers expiring with the timer process'
+ * latency.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_TMR_DEFERRED_TICK 0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Set to 1 to enable the nanosecond clock and the nanosecond timer API (aedea_now(),
+ * aedea_install_timer_ns() and aedea_rearm_timer_ns()).
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1. Requires a 64-bit integer type
+ * (PLATFORM_ARCH 32) and the PORT_CLOCK_NS() hook in platform.h.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_CLOCK_NS     0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Set to 1 to enable timer slack (aedea_set_timer_slack()).
+ *
+ * A timer with slack may expire up to its slack later than requested. Its expiry is moved to
+ * the tick within that window which is a multiple of the largest possible power of two, so
+ * timers with overlapping windows expire on the same tick and are handled in one pass of the
+ * timer process (and one wake-up in tickless mode).
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_TMR_SLACK    0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Set to 1 to allow timers to be bound to a process (aedea_bind_timer()). A bound timer posts
+ * an event to its process when it expires instead of having its timeout handler called by
+ * the timer process.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_TMR_EVENTS   0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Set to 1 to enable hard timers (AEDEA_TMR_HARD), whose timeout handlers are called from the
+ * timer tick instead of the timer process.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1. Cannot be used together with
+ * AEDEA_OPT_TMR_DEFERRED_TICK, which moves all timer work out of the tick ISR.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_HARD_TMRS    0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Set to 1 to enable timer lateness metrics (see aedea_get_timer_lateness()).
+ *
+ * Records, per timer and for all timers, how many ticks after its expiry the timer process
+ * called each timeout handler, and counts missed periods of periodic timers (expiries merged
+ * into one handler call because the handler of the previous expiry had not been called yet).
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_TMR_LATENESS 0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Number of buckets in the timer lateness histograms.
+ *
+ * Bucket 0 counts handler calls on the tick of the expiry, bucket n counts calls which were
+ * 2^(n-1) to 2^n - 1 ticks late, the last bucket counts all later ones.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_TMR_LATENESS is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1))
+#define AEDEA_OPT_TMR_LATE_BUCKETS 0x08
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_LATENESS == 1)) */
+
+/*!
+ * Set to 1 to enable the timer command queue (aedea_submit_install() and friends).
+ *
+ * Timer operations submitted through the command queue are applied in order by the timer
+ * process. Submitting a command does not lock interrupts, several threads can submit
+ * commands concurrently without blocking each other.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_TMR_CMD_QUEUE 0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Number of entries in the timer command queue, must be a power of two.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_TMR_CMD_QUEUE is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1))
+#define AEDEA_OPT_TMR_CMD_QUEUE_SIZE 0x10
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_CMD_QUEUE == 1)) */
+
+/*!
+ * Set to 1 to enable timer groups (aedea_set_timer_group(),
+ * aedea_set_timer_group_by_id() and aedea_cancel_group()).
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SOFT_TMR is set to 1.
+ */
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+#define AEDEA_OPT_USE_TMR_GROUPS   0
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+/*!
+ * Maximum number of timer groups, the group IDs range from 0 to AEDEA_OPT_MAX_TMR_GROUPS - 1.
+ * Group IDs are 8 bits wide and 0xFF is AEDEA_TMR_NO_GROUP, so at most 0xFF groups can be
+ * used.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_TMR_GROUPS is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1))
+#define AEDEA_OPT_MAX_TMR_GROUPS   0x04
+#if(AEDEA_OPT_MAX_TMR_GROUPS >= 0xFF)
+#error "AEDEA_OPT_MAX_TMR_GROUPS must be less than AEDEA_TMR_NO_GROUP (0xFF)"
+#endif
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_TMR_GROUPS == 1)) */
+
+/*!
+ * Length of a timer tick in nanoseconds.
+ *
+ * Nanosecond timeouts are rounded up to whole ticks, a timer which fires before its
+ * deadline is re-armed for the remainder. The precision of nanosecond timers is therefore
+ * limited by the tick, use a short tick together with AEDEA_OPT_TMR_TICKLESS for fine
+ * grained timeouts.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_CLOCK_NS is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1))
+#define AEDEA_OPT_TMR_TICK_NS      10000000UL
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_USE_CLOCK_NS == 1)) */
+
+
 /*!
  * Process ID for the aedea timer process.
  *
@@ -101,6 +319,228 @@
 #endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
 
 
+/*!
+ * Set to 1 to enable event time-to-live (TTL) support.
+ *
+ * When enabled, every event posted to a process with a TTL (see aedea_set_event_ttl())
+ * is stamped with the current timer tick and events older than the TTL are discarded
+ * by aedea_get_event() instead of being returned to the process.
+ *
+ * \hideinitializer
+ * \note Requires AEDEA_OPT_USE_SOFT_TMR to be set to 1, the timer tick is used as the time base.
+ */
+#define AEDEA_OPT_USE_EVENT_TTL    0
+
+
+/*!
+ * Set to 1 to enable delayed event posting (see aedea_post_event_after()).
+ *
+ * \hideinitializer
+ * \note Requires AEDEA_OPT_USE_SOFT_TMR to be set to 1. Delayed events do not use any of the
+ * AEDEA_OPT_MAX_SOFT_TMRS software timers.
+ */
+#define AEDEA_OPT_USE_DELAYED_EVTS    0
+
+
+/*!
+ * Maximum number of pending delayed events.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_DELAYED_EVTS is set to 1.
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+#define AEDEA_OPT_MAX_DELAYED_EVTS    0x08
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
+/*!
+ * Maximum size of a delayed event item in bytes.
+ *
+ * Set this to the largest event item size of all processes delayed events will be posted to.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_DELAYED_EVTS is set to 1.
+ */
+#if(AEDEA_OPT_USE_DELAYED_EVTS == 1)
+#define AEDEA_OPT_DELAYED_EVT_SIZE    0x10
+#endif    /* (AEDEA_OPT_USE_DELAYED_EVTS == 1) */
+
+
+/*!
+ * Set to 1 to give each event queue and the timer table their own lock instead of using the
+ * global critical section (AEDEA_ENTER_CRITICAL_SECTION()) for all of them.
+ *
+ * Posting to one process' queue then no longer blocks other queues or timer operations. The
+ * port has to provide port_lock_t, PORT_LOCK_INIT(), PORT_LOCK_TAKE() and PORT_LOCK_GIVE()
+ * (see platform.h).
+ *
+ * \hideinitializer
+ */
+#define AEDEA_OPT_USE_FINE_LOCKS    0
+
+
+/*!
+ * Set to 1 to enable the critical section profiler (see aedea_get_cs_profile()).
+ *
+ * The profiler measures how long each outermost critical section keeps interrupts locked
+ * with the port's PORT_CYCLES() counter. It records the longest duration with the call
+ * site of the AEDEA_ENTER_CRITICAL_SECTION() which started it, and a histogram of all
+ * durations.
+ *
+ * \hideinitializer
+ * \note Locks taken with AEDEA_OPT_USE_FINE_LOCKS set to 1 are not profiled.
+ */
+#define AEDEA_OPT_USE_CS_PROFILER    0
+
+
+/*!
+ * Number of buckets in the critical section duration histogram.
+ *
+ * Bucket n counts critical sections which lasted less than (1 << (AEDEA_OPT_CS_PROF_SHIFT + n))
+ * cycles (and not less than the limit of bucket n - 1), the last bucket counts all longer ones.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_CS_PROFILER is set to 1.
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+#define AEDEA_OPT_CS_PROF_BUCKETS    0x08
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*!
+ * Log2 of the limit of the first critical section duration histogram bucket, in cycles.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_CS_PROFILER is set to 1.
+ */
+#if(AEDEA_OPT_USE_CS_PROFILER == 1)
+#define AEDEA_OPT_CS_PROF_SHIFT    0x04
+#endif    /* (AEDEA_OPT_USE_CS_PROFILER == 1) */
+
+
+/*!
+ * Set to 1 to enable per-process runtime statistics (see aedea_get_proc_stats()).
+ *
+ * Counts process invocations and invocations which did not get any event, the time spent
+ * in each process callback and, for processes with a latency stamp buffer (see
+ * aedea_set_latency_buffer()), the time events spend in the event queue. Times are measured
+ * with the port's PORT_CYCLES() counter.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_OPT_USE_PROC_STATS    0
+
+
+/*!
+ * Set to 1 to enable scheduler loop statistics (see aedea_get_sched_stats()).
+ *
+ * Classifies each pass of the aedea_start() loop: process callbacks which got an event (or
+ * an expired timer for the timer process), callbacks which did not, passes counting down the
+ * execution delay of a process and passes skipping a disabled process. The PORT_CYCLES() time
+ * of each pass is accounted as busy or idle, and the busy percentage of the last
+ * AEDEA_OPT_SCHED_WINDOW passes is kept as the utilisation.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_OPT_USE_SCHED_STATS    0
+
+
+/*!
+ * Number of scheduler loop passes over which the statistics are accumulated before they are
+ * published and the utilisation is computed.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_SCHED_STATS is set to 1.
+ */
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+#define AEDEA_OPT_SCHED_WINDOW    0x100
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+
+/*!
+ * Set to 1 to enable the metrics block (see aedea_read_metrics()).
+ *
+ * Every AEDEA_OPT_METRICS_PERIOD passes the scheduler publishes the queue depths, dropped
+ * posts, timer counts and, if enabled, the process and scheduler statistics into a block
+ * protected by a sequence lock. Readers on other threads copy the block without ever
+ * blocking the scheduler. On the hosted Linux port, port_linux_metrics.c exports the block
+ * in the Prometheus text format.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_OPT_USE_METRICS    0
+
+
+/*!
+ * Number of scheduler loop passes between two publications of the metrics block.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_METRICS is set to 1.
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+#define AEDEA_OPT_METRICS_PERIOD    0x400
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*!
+ * Set to 1 to enable the traffic matrix (see aedea_get_traffic()).
+ *
+ * Counts the events and bytes posted by each process to each process. Events posted from
+ * outside of a process callback (ISRs, other threads, initialization code) are counted as
+ * external (see aedea_traffic_t). Delayed events and the events of bound timers are
+ * counted for the process which queued the event or bound the timer. On the hosted Linux
+ * port, port_linux_metrics.c writes the matrix as a Graphviz graph.
+ *
+ * \hideinitializer
+ * \note Without the PORT_IN_ISR() hook in platform.h, events posted by an ISR which
+ * interrupted a process callback are counted as posted by that process.
+ */
+#define AEDEA_OPT_USE_TRAFFIC    0
+
+
+/*!
+ * Set to 1 to enable the static probe points, which the port maps with the PORT_PROBE*()
+ * hooks in platform.h. On the hosted Linux port they are USDT probes of the provider
+ * "aedea" (if <sys/sdt.h> is available), which perf and bpftrace can attach to at run time:
+ *
+ * - dispatch_start(pid), dispatch_end(pid): a process callback is called and has returned.
+ * - queue_push(queue, count): an item was pushed onto a queue, count is the new depth.
+ * - queue_full(queue, size): an item was not pushed because the queue was full.
+ * - timer_expire(timer_id): a timer expired.
+ * - cs_enter(file, line), cs_exit(): the outermost critical section was entered and left,
+ *   file and line are only set if AEDEA_OPT_USE_CS_PROFILER is set to 1.
+ *
+ * If set to 0, the probe points are not compiled in.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_OPT_USE_PROBES    0
+
+
+/*!
+ * Set to 1 to enable the trace recorder (see aedea_trace_dump()).
+ *
+ * Posts, gets, process dispatches, timer installs and expiries and critical sections are
+ * recorded with a PORT_CYCLES() time stamp in a ring of AEDEA_OPT_TRACE_SIZE records, the
+ * oldest records are overwritten. tools/aedea_trace2json.c converts a dump of the ring
+ * into a Chrome/Perfetto trace.
+ *
+ * \hideinitializer
+ */
+#define AEDEA_OPT_USE_TRACE    0
+
+
+/*!
+ * Number of records in the trace ring, must be a power of two.
+ *
+ * \hideinitializer
+ * \note Only used if AEDEA_OPT_USE_TRACE is set to 1.
+ */
+#if(AEDEA_OPT_USE_TRACE == 1)
+#define AEDEA_OPT_TRACE_SIZE    0x100
+#endif    /* (AEDEA_OPT_USE_TRACE == 1) */
+
+
 #endif    /* __AEDEA_OPT_H */
 
 
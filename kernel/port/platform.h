@@ -59,9 +59,12 @@
 
 /*
  * Define platform type below to specify platform datatypes and interrupt locking/unlocking
- * macros.
+ * macros. The platform type can also be selected on the compiler's command line.
  */
+#if(!defined(EXAMPLE_AVR_GCC) && !defined(EXAMPLE_PC_TURBOC) && !defined(EXAMPLE_PC_OPEN_WATCOM) && \
+    !defined(EXAMPLE_ARM_ADS) && !defined(EXAMPLE_ARM_GCC) && !defined(EXAMPLE_LINUX_GCC))
 #define EXAMPLE_PC_TURBOC
+#endif
 
 
 /*
@@ -98,6 +101,88 @@
  */
 #define PORT_UNLOCK_INTERRUPTS()   enable()
 
+/*
+ * Atomic operation hooks, used by the timer command queue (AEDEA_OPT_USE_TMR_CMD_QUEUE). If
+ * they are not defined, AEDEA falls back to plain volatile accesses and a compare-and-swap
+ * inside a critical section, which is sufficient on single core targets.
+ *
+ * PORT_ATOMIC_LOAD(ptr) reads *ptr with acquire semantics, PORT_ATOMIC_STORE(ptr, value)
+ * writes *ptr with release semantics and PORT_ATOMIC_CAS(ptr, expected, desired) replaces
+ * *ptr by desired if it equals expected, returning TRUE if it did. ptr points to a volatile
+ * port_uint_t.
+ *
+ * #define PORT_ATOMIC_LOAD(ptr)                        __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+ * #define PORT_ATOMIC_STORE(ptr, value)                __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+ * #define PORT_ATOMIC_CAS(ptr, expected, desired)      port_atomic_cas((ptr), (expected), (desired))
+ */
+
+/*
+ * Memory barrier hook, used by the metrics block (AEDEA_OPT_USE_METRICS). If it is not
+ * defined, AEDEA assumes that the readers of the block run on the same core as the scheduler
+ * and uses no barrier.
+ *
+ * PORT_MEMORY_BARRIER() orders all memory accesses before it against all accesses after it.
+ *
+ * #define PORT_MEMORY_BARRIER()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+ */
+
+/*
+ * ISR context hook, optionally used by the traffic matrix (AEDEA_OPT_USE_TRAFFIC).
+ *
+ * PORT_IN_ISR() returns non-zero when called from an ISR.
+ *
+ * #define PORT_IN_ISR()                      port_in_isr()
+ */
+
+/*
+ * Static probe hooks, only needed if AEDEA_OPT_USE_PROBES is set to 1.
+ *
+ * PORT_PROBE0(name), PORT_PROBE1(name, arg1) and PORT_PROBE2(name, arg1, arg2) mark a probe
+ * point, name is a bare identifier and the arguments are integers or pointers.
+ *
+ * #define PORT_PROBE0(name)                  DTRACE_PROBE(aedea, name)
+ * #define PORT_PROBE1(name, arg1)            DTRACE_PROBE1(aedea, name, arg1)
+ * #define PORT_PROBE2(name, arg1, arg2)      DTRACE_PROBE2(aedea, name, arg1, arg2)
+ */
+
+/*
+ * Cycle counter hook, only needed if AEDEA_OPT_USE_CS_PROFILER, AEDEA_OPT_USE_PROC_STATS or
+ * AEDEA_OPT_USE_TRACE is set to 1.
+ *
+ * PORT_CYCLES() returns a free running port_uint_t count of CPU cycles (or of any other
+ * fine grained time unit), it may wrap around.
+ *
+ * #define PORT_CYCLES()                      port_cycles()
+ */
+
+/*
+ * Lock hooks, only needed if AEDEA_OPT_USE_FINE_LOCKS is set to 1.
+ *
+ * port_lock_t is the type of a lock, PORT_LOCK_INIT(lock_ptr) initializes a lock to the
+ * unlocked state, PORT_LOCK_TAKE(lock_ptr) and PORT_LOCK_GIVE(lock_ptr) take and release it.
+ * The locks are taken from processes and ISRs, so PORT_LOCK_TAKE() must keep the ISRs which
+ * use AEDEA from running while the lock is held, e.g. by raising the interrupt priority mask
+ * and saving the old one in the lock. The locks need not be recursive.
+ *
+ * typedef uint8_t port_lock_t;
+ * #define PORT_LOCK_INIT(lock_ptr)           (*(lock_ptr) = 0)
+ * #define PORT_LOCK_TAKE(lock_ptr)           port_lock_take(lock_ptr)
+ * #define PORT_LOCK_GIVE(lock_ptr)           port_lock_give(lock_ptr)
+ */
+
+/*
+ * Tickless timer hooks, only needed if AEDEA_OPT_TMR_TICKLESS is set to 1.
+ *
+ * PORT_TMR_ELAPSED() returns the number of whole ticks elapsed since its previous call and
+ * moves its reference point forward by that amount, keeping the fraction of a tick.
+ * PORT_TMR_SET_ONESHOT(num_ticks) programs the one-shot timer to call aedea_timer_tick()
+ * num_ticks ticks after the reference point, AEDEA_TMR_NO_EXPIRY stops it. Both are called
+ * with interrupts locked.
+ *
+ * #define PORT_TMR_ELAPSED()                 port_tmr_elapsed()
+ * #define PORT_TMR_SET_ONESHOT(num_ticks)    port_tmr_set_oneshot(num_ticks)
+ */
+
 /*!
  * Platform architecture type (8-bit, 16-bit or 32-bit).
  */
@@ -111,6 +196,15 @@
  */
 #ifdef EXAMPLE_PC_OPEN_WATCOM
 
+/*
+ * Monotonic clock hook, only needed if AEDEA_OPT_USE_CLOCK_NS is set to 1.
+ *
+ * PORT_CLOCK_NS() returns a free running 64-bit nanosecond count which never goes backwards
+ * (it may wrap around). It has to be callable from the timer ISR.
+ *
+ * #define PORT_CLOCK_NS()                    port_clock_ns()
+ */
+
 /*!
  * Platform architecture type (8-bit, 16-bit or 32-bit).
  */
@@ -145,6 +239,105 @@
 #endif    /* EXAMPLE_ARM_GCC */
 
 
+/*
+ * ----- Linux GCC (hosted) Example -----
+ *
+ * Runs AEDEA as a multi-threaded Linux process, port_linux.c has to be built along with
+ * aedea.c. Interrupts are emulated by signal handlers (e.g. a POSIX timer signal calling
+ * aedea_timer_tick()) and by other threads. A critical section masks all signals in the
+ * calling thread and takes a process wide lock, which spins for a while before sleeping
+ * on a futex. The critical section nesting level is kept per thread. The locks used with
+ * AEDEA_OPT_USE_FINE_LOCKS work the same way.
+ *
+ * Masking and unmasking the signals takes two system calls each time a thread takes its
+ * outermost lock, which is most of the cost of posting or getting an event or of a timer
+ * call on this port. Locks taken while the thread already holds one skip the mask. If no
+ * signal handler calls AEDEA, build port_linux.c with PORT_LINUX_SIGNAL_ISRS defined to 0
+ * and the signals are not masked at all.
+ *
+ * The nanosecond clock reads CLOCK_MONOTONIC. The tickless timer is a timerfd, a thread
+ * started on its first use calls aedea_timer_tick() when it fires; the tick is
+ * AEDEA_OPT_TMR_TICK_NS long if AEDEA_OPT_USE_CLOCK_NS is set to 1, 1 ms otherwise, and
+ * can be changed by defining PORT_LINUX_TICK_NS when port_linux.c is built. An application
+ * may define its own PORT_TMR_ELAPSED() and PORT_TMR_SET_ONESHOT(), e.g. to simulate time.
+ */
+#ifdef EXAMPLE_LINUX_GCC
+
+typedef int port_lock_t;                     //!< Lock type used by AEDEA_OPT_USE_FINE_LOCKS.
+
+void port_linux_lock(void);
+void port_linux_unlock(void);
+void port_linux_lock_take(port_lock_t * lock_ptr);
+void port_linux_lock_give(port_lock_t * lock_ptr);
+unsigned char port_linux_cas(volatile unsigned int * ptr, unsigned int expected, unsigned int desired);
+unsigned int port_linux_cycles(void);
+unsigned long long port_linux_clock_ns(void);
+unsigned int port_linux_tmr_elapsed(void);
+void port_linux_tmr_set_oneshot(unsigned int num_ticks);
+
+// Metrics exporter (port_linux_metrics.c), the metrics functions are only available if
+// AEDEA_OPT_USE_METRICS is set to 1 and the traffic graph if AEDEA_OPT_USE_TRAFFIC is set to 1.
+int port_linux_metrics_write(const char * path_ptr);
+int port_linux_metrics_serve(unsigned short port);
+int port_linux_traffic_write_dot(const char * path_ptr);
+
+/*!
+ * Platform specific interrupt locking macro.
+ *
+ * \hideinitializer
+ */
+#define PORT_LOCK_INTERRUPTS()     port_linux_lock()
+
+/*!
+ * Platform specific interrupt unlocking macro.
+ *
+ * \hideinitializer
+ */
+#define PORT_UNLOCK_INTERRUPTS()   port_linux_unlock()
+
+/*!
+ * Storage class for data which has to be kept per thread, such as the critical section
+ * nesting level.
+ *
+ * \hideinitializer
+ */
+#define PORT_THREAD_LOCAL          __thread
+
+#define PORT_ATOMIC_LOAD(ptr)                        __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define PORT_ATOMIC_STORE(ptr, value)                __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define PORT_ATOMIC_CAS(ptr, expected, desired)      port_linux_cas((ptr), (expected), (desired))
+#define PORT_MEMORY_BARRIER()                        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define PORT_LOCK_INIT(lock_ptr)                     (*(lock_ptr) = 0)
+#define PORT_LOCK_TAKE(lock_ptr)                     port_linux_lock_take(lock_ptr)
+#define PORT_LOCK_GIVE(lock_ptr)                     port_linux_lock_give(lock_ptr)
+
+#define PORT_CYCLES()                                port_linux_cycles()
+#define PORT_CLOCK_NS()                              port_linux_clock_ns()
+
+#if(!defined(PORT_TMR_ELAPSED) && !defined(PORT_TMR_SET_ONESHOT))
+#define PORT_TMR_ELAPSED()                           port_linux_tmr_elapsed()
+#define PORT_TMR_SET_ONESHOT(num_ticks)              port_linux_tmr_set_oneshot(num_ticks)
+#endif    /* (!defined(PORT_TMR_ELAPSED) && !defined(PORT_TMR_SET_ONESHOT)) */
+
+// USDT probes, a probe is a single nop until a tracer attaches to it.
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PORT_PROBE0(name)                            DTRACE_PROBE(aedea, name)
+#define PORT_PROBE1(name, arg1)                      DTRACE_PROBE1(aedea, name, arg1)
+#define PORT_PROBE2(name, arg1, arg2)                DTRACE_PROBE2(aedea, name, arg1, arg2)
+#endif    /* __has_include(<sys/sdt.h>) */
+#endif    /* defined(__has_include) */
+
+/*!
+ * Platform architecture type (8-bit, 16-bit or 32-bit).
+ */
+#define PLATFORM_ARCH    32
+
+#endif    /* EXAMPLE_LINUX_GCC */
+
+
 /*
  * Platform specific data types. These datatypes only apply to the platforms supported
  * in the examples.
@@ -188,6 +381,11 @@ typedef uint16_t port_uint_t;                //!< Platform unsigned int data typ
  */
 #if PLATFORM_ARCH == 32
 
+#ifdef EXAMPLE_LINUX_GCC
+// Hosted builds take the fixed width types from the C library, so that the AEDEA headers
+// can be included together with the system headers.
+#include <stdint.h>
+#else
 typedef unsigned char uint8_t;               //!< 8-bit unsigned data type.
 typedef unsigned short uint16_t;             //!< 16-bit unsigned data type.
 typedef unsigned int uint32_t;               //!< 32-bit unsigned data type.
@@ -195,6 +393,9 @@ typedef unsigned int uint32_t;               //!< 32-bit unsigned data type.
 typedef char int8_t;                         //!< 8-bit unsigned data type.
 typedef short int16_t;                       //!< 16-bit unsigned data type.
 typedef int int32_t;                         //!< 32-bit unsigned data type.
+typedef unsigned long long uint64_t;         //!< 64-bit unsigned data type.
+typedef long long int64_t;                   //!< 64-bit signed data type.
+#endif    /* EXAMPLE_LINUX_GCC */
                                              
 typedef int32_t port_int_t;                  //!< Platform signed int data type (AEDEA uses this to allow for different integer widths for different platforms).
 typedef uint32_t port_uint_t;                //!< Platform unsigned int data type (AEDEA uses this to allow for different integer widths for different platforms).
@@ -0,0 +1,373 @@
+/*!
+ * \addtogroup aedea
+ * @{
+ */
+
+
+/*!
+ * \addtogroup platform_defs
+ * @{
+ */
+
+
+/*!
+ * \file
+ * AEDEA hosted Linux port, implements the critical section lock, the locks used with
+ * AEDEA_OPT_USE_FINE_LOCKS, the atomic operations, the monotonic clock and the tickless
+ * timer used when EXAMPLE_LINUX_GCC is selected in platform.h.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+/*
+ * ----- Header files -----
+ */
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <linux/futex.h>
+#include "platform.h"
+#include "options.h"
+#include "../core/aedea.h"
+
+
+#ifndef EXAMPLE_LINUX_GCC
+#error "port_linux.c is only used with EXAMPLE_LINUX_GCC"
+#endif
+
+
+/*
+ * Number of attempts to take the lock by spinning before sleeping on the futex.
+ */
+#ifndef PORT_LINUX_SPIN_COUNT
+#define PORT_LINUX_SPIN_COUNT      100
+#endif    /* PORT_LINUX_SPIN_COUNT */
+
+
+/*
+ * Set to 0 if no signal handler calls AEDEA, e.g. when only threads and the tickless timer
+ * thread play the part of ISRs. The locks then do not mask the signals, which saves two
+ * system calls each time a thread takes its outermost lock.
+ */
+#ifndef PORT_LINUX_SIGNAL_ISRS
+#define PORT_LINUX_SIGNAL_ISRS     1
+#endif    /* PORT_LINUX_SIGNAL_ISRS */
+
+
+/*
+ * Length of a timer tick in nanoseconds for AEDEA_OPT_TMR_TICKLESS, the tick of the
+ * nanosecond clock if AEDEA_OPT_USE_CLOCK_NS is set to 1.
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+#ifndef PORT_LINUX_TICK_NS
+#ifdef AEDEA_OPT_TMR_TICK_NS
+#define PORT_LINUX_TICK_NS         AEDEA_OPT_TMR_TICK_NS
+#else
+#define PORT_LINUX_TICK_NS         1000000UL
+#endif    /* AEDEA_OPT_TMR_TICK_NS */
+#endif    /* PORT_LINUX_TICK_NS */
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * Lock states.
+ */
+#define LOCK_FREE                  0    // Not locked.
+#define LOCK_TAKEN                 1    // Locked, nobody is waiting.
+#define LOCK_CONTENDED             2    // Locked, threads may be sleeping on the futex.
+
+
+/*
+ * ----- Variables -----
+ */
+static port_lock_t global_lock = LOCK_FREE;            // Lock taken by the global critical section.
+#if(PORT_LINUX_SIGNAL_ISRS == 1)
+static __thread int num_locks_held = 0;                // Number of locks held by the thread, only the outermost one masks the signals.
+static __thread sigset_t saved_sig_mask;               // Signal mask of the thread before it took its first lock.
+#endif    /* (PORT_LINUX_SIGNAL_ISRS == 1) */
+
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+static pthread_once_t tmr_once = PTHREAD_ONCE_INIT;     // Starts the tickless timer on first use.
+static int tmr_fd = -1;                                // Timer file descriptor of the one-shot timer.
+static unsigned long long tmr_ref_ns;                  // Reference point of port_linux_tmr_elapsed().
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * ----- Local function prototypes -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+static void tmr_start(void);
+static void * tmr_thread(void * arg_ptr);
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * ----- Function: port_linux_lock() -----
+ */
+void port_linux_lock(void)
+{
+     port_linux_lock_take(&global_lock);
+}
+
+
+/*
+ * ----- Function: port_linux_unlock() -----
+ */
+void port_linux_unlock(void)
+{
+     port_linux_lock_give(&global_lock);
+}
+
+
+/*
+ * ----- Function: port_linux_lock_take() -----
+ */
+void port_linux_lock_take(port_lock_t * lock_ptr)
+{
+#if(PORT_LINUX_SIGNAL_ISRS == 1)
+     sigset_t all_sigs;
+#endif    /* (PORT_LINUX_SIGNAL_ISRS == 1) */
+     int state;
+     int spin;
+
+#if(PORT_LINUX_SIGNAL_ISRS == 1)
+     // Signal handlers play the part of ISRs, mask them before taking the first lock so
+     // that a handler never waits for a lock held by the thread it interrupted. Locks
+     // nested inside it, such as the fine locks taken in a critical section, need no
+     // system call.
+     if(0 == num_locks_held)
+     {
+          sigfillset(&all_sigs);
+          pthread_sigmask(SIG_BLOCK, &all_sigs, &saved_sig_mask);
+     }
+     num_locks_held++;
+#endif    /* (PORT_LINUX_SIGNAL_ISRS == 1) */
+
+     // Critical sections are short, so spin for a while first.
+     for(spin = 0; spin < PORT_LINUX_SPIN_COUNT; spin++)
+     {
+          state = LOCK_FREE;
+          if(__atomic_compare_exchange_n(lock_ptr, &state, LOCK_TAKEN, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+          {
+               return;
+          }
+
+#if(defined(__i386__) || defined(__x86_64__))
+          __asm__ __volatile__("pause");
+#endif
+     }
+
+     // Mark the lock as contended and sleep until the owner releases it.
+     state = __atomic_exchange_n(lock_ptr, LOCK_CONTENDED, __ATOMIC_ACQUIRE);
+     while(LOCK_FREE != state)
+     {
+          syscall(SYS_futex, lock_ptr, FUTEX_WAIT_PRIVATE, LOCK_CONTENDED, NULL, NULL, 0);
+          state = __atomic_exchange_n(lock_ptr, LOCK_CONTENDED, __ATOMIC_ACQUIRE);
+     }
+}
+
+
+/*
+ * ----- Function: port_linux_lock_give() -----
+ */
+void port_linux_lock_give(port_lock_t * lock_ptr)
+{
+     // Release the lock, wake up one sleeper if there may be any.
+     if(LOCK_CONTENDED == __atomic_exchange_n(lock_ptr, LOCK_FREE, __ATOMIC_RELEASE))
+     {
+          syscall(SYS_futex, lock_ptr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+     }
+
+#if(PORT_LINUX_SIGNAL_ISRS == 1)
+     // Unmask the signals once the thread holds no lock anymore.
+     num_locks_held--;
+     if(0 == num_locks_held)
+     {
+          pthread_sigmask(SIG_SETMASK, &saved_sig_mask, NULL);
+     }
+#endif    /* (PORT_LINUX_SIGNAL_ISRS == 1) */
+}
+
+
+/*
+ * ----- Function: port_linux_cas() -----
+ */
+unsigned char port_linux_cas(volatile unsigned int * ptr, unsigned int expected, unsigned int desired)
+{
+     return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ? TRUE : FALSE;
+}
+
+
+
+/*
+ * ----- Function: port_linux_cycles() -----
+ */
+unsigned int port_linux_cycles(void)
+{
+#if(defined(__i386__) || defined(__x86_64__))
+     unsigned int lo;
+     unsigned int hi;
+
+     // Time stamp counter, only the low word is needed for differences.
+     __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+     (void)hi;
+
+     return lo;
+#else
+     struct timespec now;
+
+     // No portable cycle counter, count nanoseconds instead.
+     clock_gettime(CLOCK_MONOTONIC, &now);
+
+     return (unsigned int)((unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec);
+#endif
+}
+
+
+/*
+ * ----- Function: port_linux_clock_ns() -----
+ */
+unsigned long long port_linux_clock_ns(void)
+{
+     struct timespec now;
+
+     clock_gettime(CLOCK_MONOTONIC, &now);
+
+     return ((unsigned long long)now.tv_sec * 1000000000ULL) + (unsigned long long)now.tv_nsec;
+}
+
+
+/*
+ * ----- Function: port_linux_tmr_elapsed() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+unsigned int port_linux_tmr_elapsed(void)
+{
+     unsigned long long num_ticks;
+
+     pthread_once(&tmr_once, tmr_start);
+
+     // Move the reference point by whole ticks only, the fraction counts towards the next call.
+     num_ticks = (port_linux_clock_ns() - tmr_ref_ns) / PORT_LINUX_TICK_NS;
+     tmr_ref_ns += num_ticks * PORT_LINUX_TICK_NS;
+
+     return (unsigned int)num_ticks;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * ----- Function: port_linux_tmr_set_oneshot() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+void port_linux_tmr_set_oneshot(unsigned int num_ticks)
+{
+     struct itimerspec spec;
+     unsigned long long deadline_ns;
+
+     pthread_once(&tmr_once, tmr_start);
+
+     // An all zero value stops the timer, a deadline which has already passed fires it at once.
+     spec.it_interval.tv_sec = 0;
+     spec.it_interval.tv_nsec = 0;
+     spec.it_value.tv_sec = 0;
+     spec.it_value.tv_nsec = 0;
+
+     if(AEDEA_TMR_NO_EXPIRY != num_ticks)
+     {
+          deadline_ns = tmr_ref_ns + ((unsigned long long)num_ticks * PORT_LINUX_TICK_NS);
+          spec.it_value.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+          spec.it_value.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+     }
+
+     timerfd_settime(tmr_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * ----- Function: tmr_start() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+static void tmr_start(void)
+{
+     pthread_t tid;
+     sigset_t all_sigs;
+     sigset_t old_sigs;
+
+     tmr_ref_ns = port_linux_clock_ns();
+     tmr_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+
+     // The timer thread plays the part of the timer ISR, it must not take signals meant
+     // for the application's threads.
+     sigfillset(&all_sigs);
+     pthread_sigmask(SIG_BLOCK, &all_sigs, &old_sigs);
+     pthread_create(&tid, NULL, tmr_thread, NULL);
+     pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+     pthread_detach(tid);
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*
+ * ----- Function: tmr_thread() -----
+ */
+#if((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1))
+static void * tmr_thread(void * arg_ptr)
+{
+     unsigned long long num_expiries;
+
+     (void)arg_ptr;
+
+     // Call the tick each time the one-shot timer fires.
+     while(TRUE)
+     {
+          if((ssize_t)sizeof(num_expiries) == read(tmr_fd, &num_expiries, sizeof(num_expiries)))
+          {
+               aedea_timer_tick();
+          }
+     }
+
+     return NULL;
+}
+#endif    /* ((AEDEA_OPT_USE_SOFT_TMR == 1) && (AEDEA_OPT_TMR_TICKLESS == 1)) */
+
+
+/*----------------------------------------------------------------------------*/
+/*! @} */
+/*! @} */
@@ -0,0 +1,430 @@
+/*!
+ * \addtogroup aedea
+ * @{
+ */
+
+
+/*!
+ * \addtogroup platform_defs
+ * @{
+ */
+
+
+/*!
+ * \file
+ * AEDEA hosted Linux metrics exporter, writes the metrics block (see aedea_read_metrics())
+ * in the Prometheus text exposition format to a file or serves it to scrapers on a loopback
+ * TCP port, and writes the traffic matrix (see aedea_get_traffic()) as a Graphviz graph.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+/*
+ * ----- Header files -----
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "platform.h"
+#include "options.h"
+#include "../core/aedea.h"
+
+
+#ifndef EXAMPLE_LINUX_GCC
+#error "port_linux_metrics.c is only used with EXAMPLE_LINUX_GCC"
+#endif
+
+#if((AEDEA_OPT_USE_METRICS == 0) && (AEDEA_OPT_USE_TRAFFIC == 0))
+#error "port_linux_metrics.c requires AEDEA_OPT_USE_METRICS or AEDEA_OPT_USE_TRAFFIC"
+#endif
+
+
+/*
+ * Receive and send timeout of a scrape connection in seconds, an idle client must not
+ * block the server.
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+#define METRICS_CONN_TIMEOUT  2
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*
+ * Maximum number of traffic matrix entries exported, one for each pair of processes.
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+#define MAX_TRAFFIC_ENTRIES   ((AEDEA_OPT_MAX_PROCESSES + 2) * (AEDEA_OPT_MAX_PROCESSES + 1))
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * ----- Local function prototypes -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+static void metrics_print_header(FILE * out_ptr, const char * name_ptr, const char * type_ptr, const char * help_ptr);
+static void metrics_print(FILE * out_ptr);
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+#if((AEDEA_OPT_USE_METRICS == 1) && (AEDEA_OPT_USE_TRAFFIC == 1))
+static void metrics_print_traffic_src(FILE * out_ptr, const char * name_ptr, const aedea_traffic_t * entry_ptr);
+#endif    /* ((AEDEA_OPT_USE_METRICS == 1) && (AEDEA_OPT_USE_TRAFFIC == 1)) */
+
+
+/*
+ * ----- Function: port_linux_metrics_write() -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+int port_linux_metrics_write(const char * path_ptr)
+{
+     char tmp_path[256];
+     FILE * out_ptr;
+
+     // Write to a temporary file and rename it, so that a collector reading the file
+     // (e.g. the node exporter's textfile collector) never sees a partial block.
+     if(snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path_ptr) >= (int)sizeof(tmp_path))
+     {
+          return -1;
+     }
+
+     out_ptr = fopen(tmp_path, "w");
+     if(NULL == out_ptr)
+     {
+          return -1;
+     }
+
+     metrics_print(out_ptr);
+
+     if(0 != fclose(out_ptr))
+     {
+          unlink(tmp_path);
+          return -1;
+     }
+
+     return rename(tmp_path, path_ptr);
+}
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*
+ * ----- Function: port_linux_metrics_serve() -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+int port_linux_metrics_serve(unsigned short port)
+{
+     struct sockaddr_in addr;
+     struct timeval timeout;
+     char request[1024];
+     char * response_ptr;
+     size_t response_size;
+     size_t sent;
+     ssize_t num_sent;
+     FILE * out_ptr;
+     int listen_fd;
+     int conn_fd;
+     int on = 1;
+
+     listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+     if(listen_fd < 0)
+     {
+          return -1;
+     }
+
+     // Only local scrapers are served.
+     memset(&addr, 0, sizeof(addr));
+     addr.sin_family = AF_INET;
+     addr.sin_port = htons(port);
+     addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+     setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+     if((bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) || (listen(listen_fd, 4) < 0))
+     {
+          close(listen_fd);
+          return -1;
+     }
+
+     // Answer every request with the current block, whatever the requested path.
+     while(1)
+     {
+          conn_fd = accept(listen_fd, NULL, NULL);
+          if(conn_fd < 0)
+          {
+               continue;
+          }
+
+          timeout.tv_sec = METRICS_CONN_TIMEOUT;
+          timeout.tv_usec = 0;
+          setsockopt(conn_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+          setsockopt(conn_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+          if(read(conn_fd, request, sizeof(request)) < 0)
+          {
+               close(conn_fd);
+               continue;
+          }
+
+          // The response is built in memory and sent with MSG_NOSIGNAL, a scraper which
+          // hangs up early must not kill the host application with SIGPIPE.
+          out_ptr = open_memstream(&response_ptr, &response_size);
+          if(NULL == out_ptr)
+          {
+               close(conn_fd);
+               continue;
+          }
+
+          fputs("HTTP/1.0 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Connection: close\r\n"
+                "\r\n", out_ptr);
+          metrics_print(out_ptr);
+
+          if(0 == fclose(out_ptr))
+          {
+               for(sent = 0; sent < response_size; sent += (size_t)num_sent)
+               {
+                    num_sent = send(conn_fd, response_ptr + sent, response_size - sent, MSG_NOSIGNAL);
+                    if(num_sent <= 0)
+                    {
+                         break;
+                    }
+               }
+          }
+
+          free(response_ptr);
+          close(conn_fd);
+     }
+}
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*
+ * ----- Function: port_linux_traffic_write_dot() -----
+ */
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+int port_linux_traffic_write_dot(const char * path_ptr)
+{
+     aedea_traffic_t entries[MAX_TRAFFIC_ENTRIES];
+     unsigned long max_count = 1;
+     unsigned int num_entries;
+     unsigned int n;
+     FILE * out_ptr;
+
+     num_entries = aedea_get_traffic(entries, MAX_TRAFFIC_ENTRIES);
+
+     out_ptr = fopen(path_ptr, "w");
+     if(NULL == out_ptr)
+     {
+          return -1;
+     }
+
+     for(n = 0; n < num_entries; n++)
+     {
+          if(entries[n].count > max_count)
+          {
+               max_count = entries[n].count;
+          }
+     }
+
+     // One edge per pair of processes, the heaviest paths are drawn thickest.
+     fputs("digraph aedea_traffic {\n"
+           "     node [shape=box];\n"
+           "     external [label=\"ISR / external\", shape=ellipse];\n", out_ptr);
+     for(n = 0; n < num_entries; n++)
+     {
+          if(TRUE == entries[n].external)
+          {
+               fputs("     external", out_ptr);
+          }
+          else
+          {
+               fprintf(out_ptr, "     pid%u", entries[n].src_pid);
+          }
+          fprintf(out_ptr, " -> pid%u [label=\"%u events\\n%lu bytes\", penwidth=%.2f];\n",
+                  entries[n].dst_pid, entries[n].count, entries[n].bytes,
+                  1.0 + ((7.0 * entries[n].count) / max_count));
+     }
+     fputs("}\n", out_ptr);
+
+     return (0 == fclose(out_ptr)) ? 0 : -1;
+}
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+
+/*
+ * ----- Function: metrics_print_header() -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+static void metrics_print_header(FILE * out_ptr, const char * name_ptr, const char * type_ptr, const char * help_ptr)
+{
+     fprintf(out_ptr, "# HELP %s %s\n# TYPE %s %s\n", name_ptr, help_ptr, name_ptr, type_ptr);
+}
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*
+ * ----- Function: metrics_print_traffic_src() -----
+ */
+#if((AEDEA_OPT_USE_METRICS == 1) && (AEDEA_OPT_USE_TRAFFIC == 1))
+static void metrics_print_traffic_src(FILE * out_ptr, const char * name_ptr, const aedea_traffic_t * entry_ptr)
+{
+     // Print the sample name and the source label, the caller completes the sample.
+     if(TRUE == entry_ptr->external)
+     {
+          fprintf(out_ptr, "%s{src=\"external\"", name_ptr);
+     }
+     else
+     {
+          fprintf(out_ptr, "%s{src=\"%u\"", name_ptr, entry_ptr->src_pid);
+     }
+}
+#endif    /* ((AEDEA_OPT_USE_METRICS == 1) && (AEDEA_OPT_USE_TRAFFIC == 1)) */
+
+
+/*
+ * ----- Function: metrics_print() -----
+ */
+#if(AEDEA_OPT_USE_METRICS == 1)
+static void metrics_print(FILE * out_ptr)
+{
+     aedea_metrics_t metrics;
+     unsigned int n;
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     aedea_traffic_t entries[MAX_TRAFFIC_ENTRIES];
+     unsigned int num_entries;
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+
+     aedea_read_metrics(&metrics);
+
+     metrics_print_header(out_ptr, "aedea_metrics_generation", "counter", "Number of times the metrics block was published.");
+     fprintf(out_ptr, "aedea_metrics_generation %u\n", metrics.generation);
+
+     metrics_print_header(out_ptr, "aedea_queue_depth", "gauge", "Number of events in the event queue of a process.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_queue_depth{pid=\"%u\"} %u\n", metrics.procs[n].pid, metrics.procs[n].queue_depth);
+     }
+
+     metrics_print_header(out_ptr, "aedea_queue_size", "gauge", "Capacity of the event queue of a process.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_queue_size{pid=\"%u\"} %u\n", metrics.procs[n].pid, metrics.procs[n].queue_size);
+     }
+
+     metrics_print_header(out_ptr, "aedea_queue_dropped_total", "counter", "Events not posted because the event queue was full.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_queue_dropped_total{pid=\"%u\"} %u\n", metrics.procs[n].pid, metrics.procs[n].num_dropped);
+     }
+
+#if(AEDEA_OPT_USE_EVENT_TTL == 1)
+     metrics_print_header(out_ptr, "aedea_queue_expired_total", "counter", "Events discarded because their TTL expired.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_queue_expired_total{pid=\"%u\"} %u\n", metrics.procs[n].pid, metrics.procs[n].num_expired);
+     }
+#endif    /* (AEDEA_OPT_USE_EVENT_TTL == 1) */
+
+#if(AEDEA_OPT_USE_PROC_STATS == 1)
+     metrics_print_header(out_ptr, "aedea_process_invocations_total", "counter", "Number of calls of the process callback.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_process_invocations_total{pid=\"%u\"} %u\n", metrics.procs[n].pid, metrics.procs[n].invocations);
+     }
+
+     metrics_print_header(out_ptr, "aedea_process_empty_invocations_total", "counter", "Number of calls in which the process did not get any event.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_process_empty_invocations_total{pid=\"%u\"} %u\n", metrics.procs[n].pid, metrics.procs[n].empty_invocations);
+     }
+
+     metrics_print_header(out_ptr, "aedea_process_cycles_total", "counter", "PORT_CYCLES() time spent in the process callback.");
+     for(n = 0; n < metrics.num_processes; n++)
+     {
+          fprintf(out_ptr, "aedea_process_cycles_total{pid=\"%u\"} %lu\n", metrics.procs[n].pid, metrics.procs[n].total_cycles);
+     }
+#endif    /* (AEDEA_OPT_USE_PROC_STATS == 1) */
+
+#if(AEDEA_OPT_USE_SOFT_TMR == 1)
+     metrics_print_header(out_ptr, "aedea_tick_count", "gauge", "Timer ticks since initialization (wraps around).");
+     fprintf(out_ptr, "aedea_tick_count %u\n", metrics.tick_count);
+
+     metrics_print_header(out_ptr, "aedea_timers", "gauge", "Number of installed timers.");
+     fprintf(out_ptr, "aedea_timers %u\n", metrics.num_timers);
+
+     metrics_print_header(out_ptr, "aedea_timers_pending", "gauge", "Expired timers waiting for the timer process.");
+     fprintf(out_ptr, "aedea_timers_pending %u\n", metrics.num_pending_timers);
+#endif    /* (AEDEA_OPT_USE_SOFT_TMR == 1) */
+
+#if(AEDEA_OPT_USE_SCHED_STATS == 1)
+     metrics_print_header(out_ptr, "aedea_sched_passes_total", "counter", "Scheduler loop passes by kind.");
+     fprintf(out_ptr, "aedea_sched_passes_total{kind=\"busy\"} %lu\n", metrics.sched.busy_calls);
+     fprintf(out_ptr, "aedea_sched_passes_total{kind=\"empty\"} %lu\n", metrics.sched.empty_calls);
+     fprintf(out_ptr, "aedea_sched_passes_total{kind=\"delayed\"} %lu\n", metrics.sched.delayed_passes);
+     fprintf(out_ptr, "aedea_sched_passes_total{kind=\"disabled\"} %lu\n", metrics.sched.disabled_passes);
+
+     metrics_print_header(out_ptr, "aedea_sched_cycles_total", "counter", "PORT_CYCLES() time of the scheduler loop, busy or idle.");
+     fprintf(out_ptr, "aedea_sched_cycles_total{state=\"busy\"} %lu\n", metrics.sched.busy_cycles);
+     fprintf(out_ptr, "aedea_sched_cycles_total{state=\"idle\"} %lu\n", metrics.sched.idle_cycles);
+
+     metrics_print_header(out_ptr, "aedea_sched_utilisation_percent", "gauge", "Busy percentage of the scheduler during the last window.");
+     fprintf(out_ptr, "aedea_sched_utilisation_percent %u\n", metrics.sched.utilisation);
+#endif    /* (AEDEA_OPT_USE_SCHED_STATS == 1) */
+
+#if(AEDEA_OPT_USE_TRAFFIC == 1)
+     // The traffic matrix is read directly, it is not part of the metrics block.
+     num_entries = aedea_get_traffic(entries, MAX_TRAFFIC_ENTRIES);
+
+     metrics_print_header(out_ptr, "aedea_traffic_events_total", "counter", "Events posted from a source to a destination process.");
+     for(n = 0; n < num_entries; n++)
+     {
+          metrics_print_traffic_src(out_ptr, "aedea_traffic_events_total", &(entries[n]));
+          fprintf(out_ptr, ",dst=\"%u\"} %u\n", entries[n].dst_pid, entries[n].count);
+     }
+
+     metrics_print_header(out_ptr, "aedea_traffic_bytes_total", "counter", "Bytes posted from a source to a destination process.");
+     for(n = 0; n < num_entries; n++)
+     {
+          metrics_print_traffic_src(out_ptr, "aedea_traffic_bytes_total", &(entries[n]));
+          fprintf(out_ptr, ",dst=\"%u\"} %lu\n", entries[n].dst_pid, entries[n].bytes);
+     }
+#endif    /* (AEDEA_OPT_USE_TRAFFIC == 1) */
+}
+#endif    /* (AEDEA_OPT_USE_METRICS == 1) */
+
+
+/*----------------------------------------------------------------------------*/
+/*! @} */
+/*! @} */
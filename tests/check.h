@@ -0,0 +1,70 @@
+/*!
+ * \file
+ * Check macros of the AEDEA host tests. A failed check prints its location and condition
+ * and exits the test program with status 1.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+#ifndef __CHECK_H
+#define __CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*!
+ * Check that a condition holds, exit the test program if it does not.
+ *
+ * \hideinitializer
+ */
+#define CHECK(cond)                                                                        \
+     do                                                                                    \
+     {                                                                                     \
+          if(!(cond))                                                                      \
+          {                                                                                \
+               fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);    \
+               exit(1);                                                                    \
+          }                                                                                \
+     }                                                                                     \
+     while(0)
+
+
+/*!
+ * Report a passed test.
+ *
+ * \hideinitializer
+ */
+#define PASS(name)    printf("PASS %s\n", (name))
+
+#endif    /* __CHECK_H */
@@ -0,0 +1,135 @@
+/*!
+ * \file
+ * Timer ID tests: the IDs of timers installed with a handle are not looked up, a timer
+ * installed with aedea_install_timeout_handler() is found by its ID even if a handle timer
+ * has the same ID.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+
+/*
+ * ----- Header files -----
+ */
+#include "check.h"
+#include "aedea.c"
+
+
+/*
+ * ----- Defines -----
+ */
+#define SHARED_ID             7
+
+
+/*
+ * ----- Local function prototypes -----
+ */
+static void tmr_handler(uint8_t timer_id, void * arg_ptr);
+static void run_ticks(port_uint_t num_ticks);
+
+
+/*
+ * ----- Variables -----
+ */
+static int id_calls = 0;                     // Timeout handler calls of the ID timer.
+static int handle_calls = 0;                 // Timeout handler calls of the handle timer.
+
+
+/*
+ * ----- Function: main() -----
+ */
+int main(void)
+{
+     aedea_tmr_handle_t handle;
+
+     aedea_init();
+
+     // The handle timer takes the first free slot, so a lookup which does not skip it
+     // would find it before the ID timer.
+     CHECK(TRUE == aedea_install_timer(&handle, tmr_handler, &handle_calls, SHARED_ID, 5, AEDEA_TMR_ONE_SHOT));
+     CHECK(TRUE == aedea_install_timeout_handler(tmr_handler, &id_calls, SHARED_ID, 10, AEDEA_TMR_ONE_SHOT));
+
+     // Refreshing by ID moves the ID timer only.
+     CHECK(TRUE == aedea_refresh_timer(SHARED_ID, 1));
+     run_ticks(1);
+     CHECK(1 == id_calls);
+     CHECK(0 == handle_calls);
+
+     run_ticks(4);
+     CHECK(1 == id_calls);
+     CHECK(1 == handle_calls);
+
+     // Deleting by ID releases the ID timer only, the handle stays valid.
+     CHECK(TRUE == aedea_delete_timer(SHARED_ID));
+     CHECK(FALSE == aedea_delete_timer(SHARED_ID));
+     CHECK(FALSE == aedea_refresh_timer(SHARED_ID, 1));
+     CHECK(TRUE == aedea_rearm_timer(handle, 2));
+     run_ticks(2);
+     CHECK(1 == id_calls);
+     CHECK(2 == handle_calls);
+
+     CHECK(TRUE == aedea_cancel_timer(handle));
+     CHECK(FALSE == aedea_rearm_timer(handle, 2));
+
+     PASS("tmr_ids");
+
+     return 0;
+}
+
+
+/*
+ * ----- Function: tmr_handler() -----
+ */
+static void tmr_handler(uint8_t timer_id, void * arg_ptr)
+{
+     CHECK(SHARED_ID == timer_id);
+
+     (*(int *)arg_ptr)++;
+}
+
+
+/*
+ * ----- Function: run_ticks() -----
+ */
+static void run_ticks(port_uint_t num_ticks)
+{
+     port_uint_t n;
+
+     // Tick the timers and call the handlers of the expired ones, as the timer process would.
+     for(n = 0; n < num_ticks; n++)
+     {
+          aedea_timer_tick();
+     }
+
+     timer_process(NULL);
+}
@@ -0,0 +1,155 @@
+/*!
+ * \file
+ * Timer lateness tests with the tickless timer: the lateness of a handler call includes the
+ * ticks which elapsed after the expiry and were not credited to the tick count yet.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+
+/*
+ * ----- Header files -----
+ */
+#include "check.h"
+
+
+/*
+ * Tickless timer hooks of the test, a simulated clock which only moves when the test
+ * advances it.
+ */
+#define PORT_TMR_ELAPSED()                 test_tmr_elapsed()
+#define PORT_TMR_SET_ONESHOT(num_ticks)    test_tmr_set_oneshot(num_ticks)
+
+static unsigned int test_tmr_elapsed(void);
+static void test_tmr_set_oneshot(unsigned int num_ticks);
+
+#include "aedea.c"
+
+
+/*
+ * ----- Defines -----
+ */
+#define TMR_ID                1
+
+
+/*
+ * ----- Local function prototypes -----
+ */
+static void tmr_handler(uint8_t timer_id, void * arg_ptr);
+
+
+/*
+ * ----- Variables -----
+ */
+static unsigned int clock_ticks = 0;         // Ticks elapsed on the simulated clock.
+static unsigned int clock_ref = 0;           // Reference point of PORT_TMR_ELAPSED().
+static unsigned int oneshot_ticks = 0;       // Last one-shot timeout programmed.
+static int calls = 0;                        // Timeout handler calls.
+
+
+/*
+ * ----- Function: main() -----
+ */
+int main(void)
+{
+     aedea_tmr_late_t late;
+
+     aedea_init();
+
+     CHECK(TRUE == aedea_install_timeout_handler(tmr_handler, NULL, TMR_ID, 5, AEDEA_TMR_PERIODIC));
+     CHECK(5 == oneshot_ticks);
+
+     // The one-shot timer fires on time, the timer process runs 3 ticks later.
+     clock_ticks += 5;
+     aedea_timer_tick();
+     clock_ticks += 3;
+     timer_process(NULL);
+
+     CHECK(1 == calls);
+     CHECK(TRUE == aedea_get_timer_lateness(TMR_ID, &late));
+     CHECK(1 == late.count);
+     CHECK(3 == late.max);
+
+     // The next period expires at tick 10, which was credited when the lateness was measured.
+     CHECK(2 == oneshot_ticks);
+
+     // The one-shot timer fires late, the timer process runs right away.
+     clock_ticks += 4;
+     aedea_timer_tick();
+     timer_process(NULL);
+
+     CHECK(2 == calls);
+     CHECK(TRUE == aedea_get_timer_lateness(TMR_ID, &late));
+     CHECK(2 == late.count);
+     CHECK(3 == late.max);
+     CHECK(5 == late.total);
+
+     PASS("tmr_lateness");
+
+     return 0;
+}
+
+
+/*
+ * ----- Function: test_tmr_elapsed() -----
+ */
+static unsigned int test_tmr_elapsed(void)
+{
+     unsigned int elapsed = clock_ticks - clock_ref;
+
+     clock_ref = clock_ticks;
+
+     return elapsed;
+}
+
+
+/*
+ * ----- Function: test_tmr_set_oneshot() -----
+ */
+static void test_tmr_set_oneshot(unsigned int num_ticks)
+{
+     oneshot_ticks = num_ticks;
+}
+
+
+/*
+ * ----- Function: tmr_handler() -----
+ */
+static void tmr_handler(uint8_t timer_id, void * arg_ptr)
+{
+     (void)arg_ptr;
+
+     CHECK(TMR_ID == timer_id);
+
+     calls++;
+}
@@ -0,0 +1,170 @@
+/*!
+ * \file
+ * Timer tick race test with AEDEA_OPT_USE_FINE_LOCKS: one thread ticks the timers while
+ * another installs and cancels timers, neither may hang and no timer may be lost.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+
+/*
+ * ----- Header files -----
+ */
+#include <pthread.h>
+#include <unistd.h>
+#include "check.h"
+#include "aedea.c"
+
+
+/*
+ * ----- Defines -----
+ */
+#define NUM_ROUNDS            200000    // Number of install/cancel rounds of the timer thread.
+#define TIMEOUT_SECS          30        // Time after which the test is considered hung.
+
+
+/*
+ * ----- Local function prototypes -----
+ */
+static void * tick_thread(void * arg_ptr);
+static void * timer_thread(void * arg_ptr);
+static void tmr_handler(uint8_t timer_id, void * arg_ptr);
+
+
+/*
+ * ----- Variables -----
+ */
+static volatile int timers_done = 0;         // Set by the timer thread when all rounds are done.
+static volatile int ticks_stop = 0;          // Set to stop the tick thread.
+
+
+/*
+ * ----- Function: main() -----
+ */
+int main(void)
+{
+     pthread_t tick_tid;
+     pthread_t timer_tid;
+     sw_tmr_t * tmr_ptr;
+     int num_free;
+     int secs;
+
+     aedea_init();
+
+     CHECK(0 == pthread_create(&tick_tid, NULL, tick_thread, NULL));
+     CHECK(0 == pthread_create(&timer_tid, NULL, timer_thread, NULL));
+
+     // The main thread takes no locks, so it can tell a hang from a slow run.
+     for(secs = 0; (0 == timers_done) && (secs < TIMEOUT_SECS); secs++)
+     {
+          sleep(1);
+     }
+     CHECK(0 != timers_done);
+
+     ticks_stop = 1;
+     CHECK(0 == pthread_join(tick_tid, NULL));
+     CHECK(0 == pthread_join(timer_tid, NULL));
+
+     // Every timer was cancelled, all of them must be back on the free list.
+     timer_process(NULL);
+     CHECK(0 == num_timers);
+
+     num_free = 0;
+     for(tmr_ptr = tmr_free_ptr; NULL != tmr_ptr; tmr_ptr = tmr_ptr->next_ptr)
+     {
+          num_free++;
+     }
+     CHECK(AEDEA_OPT_MAX_SOFT_TMRS == num_free);
+
+     PASS("tmr_tick_race");
+
+     return 0;
+}
+
+
+/*
+ * ----- Function: tick_thread() -----
+ */
+static void * tick_thread(void * arg_ptr)
+{
+     (void)arg_ptr;
+
+     // Plays the part of the tick ISR.
+     while(0 == ticks_stop)
+     {
+          aedea_timer_tick();
+     }
+
+     return NULL;
+}
+
+
+/*
+ * ----- Function: timer_thread() -----
+ */
+static void * timer_thread(void * arg_ptr)
+{
+     aedea_tmr_handle_t handles[2];
+     long n;
+
+     (void)arg_ptr;
+
+     // Install timers which expire within a few ticks and cancel them again, calling the
+     // timer process now and then to call the handlers of the expired ones.
+     for(n = 0; n < NUM_ROUNDS; n++)
+     {
+          CHECK(TRUE == aedea_install_timer(&(handles[0]), tmr_handler, NULL, 1, 1 + (n % 3), AEDEA_TMR_ONE_SHOT));
+          CHECK(TRUE == aedea_install_timer(&(handles[1]), tmr_handler, NULL, 2, 1 + (n % 2), AEDEA_TMR_PERIODIC));
+          CHECK(TRUE == aedea_cancel_timer(handles[0]));
+          CHECK(TRUE == aedea_cancel_timer(handles[1]));
+
+          if(0 == (n % 16))
+          {
+               timer_process(NULL);
+          }
+     }
+
+     timers_done = 1;
+
+     return NULL;
+}
+
+
+/*
+ * ----- Function: tmr_handler() -----
+ */
+static void tmr_handler(uint8_t timer_id, void * arg_ptr)
+{
+     (void)timer_id;
+     (void)arg_ptr;
+}
@@ -0,0 +1,322 @@
+/*!
+ * \file
+ * Converts an AEDEA trace dump (see aedea_trace_dump()) into a Chrome/Perfetto JSON trace,
+ * which can be opened with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Build with any hosted C compiler, e.g. "cc -o aedea_trace2json aedea_trace2json.c".
+ *
+ * Usage: aedea_trace2json [-c cycles_per_us] dump.bin > trace.json
+ *
+ * Each process gets its own track showing its dispatches, with arrows from the posting of an
+ * event to the aedea_get_event() call which got it, or to its discard if its TTL expired.
+ * Timer installs and expiries and critical sections have tracks of their own.
+ */
+
+
+/*
+ * Copyright (c) 2007, Shahzeb Ihsan.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above copyright
+ *        notice, this list of conditions and the following disclaimer.
+ *     
+ *     2. Redistributions in binary form must reproduce the above copyright
+ *        notice, this list of conditions and the following disclaimer in the
+ *        documentation and/or other materials provided with the distribution.
+ *
+ *     3. Neither the name of the author nor the names of its contributors may be
+ *        used to endorse or promote products derived from this software without
+ *        specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * This file is part of the AEDEA distribution.
+ */
+
+
+/*
+ * ----- Header files -----
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*
+ * Trace record types, see AEDEA_TRACE_* in aedea.h.
+ */
+#define TRACE_POST              0
+#define TRACE_GET               1
+#define TRACE_DISPATCH_START    2
+#define TRACE_DISPATCH_END      3
+#define TRACE_TMR_INSTALL       4
+#define TRACE_TMR_EXPIRE        5
+#define TRACE_CS_ENTER          6
+#define TRACE_CS_EXIT           7
+#define TRACE_DISCARD           8
+
+
+/*
+ * Track IDs of the tracks which do not belong to a process (process IDs are 0 to 255).
+ */
+#define TID_TIMERS              1000
+#define TID_CS                  1001
+#define TID_OTHER               1002
+
+
+/*
+ * ----- Variables -----
+ */
+static unsigned char * dump_ptr;             // The dump file.
+static long dump_size;                       // Size of the dump file in bytes.
+static unsigned int uint_size;               // Size of port_uint_t on the target.
+static int big_endian;                       // Non-zero if the target is big endian.
+static int first_event = 1;                  // Zero once an event has been printed.
+
+
+/*
+ * ----- Function: get_uint() -----
+ */
+static unsigned long get_uint(const unsigned char * ptr)
+{
+     unsigned long value = 0;
+     unsigned int n;
+
+     for(n = 0; n < uint_size; n++)
+     {
+          value = (value << 8) | ptr[big_endian ? n : (uint_size - 1 - n)];
+     }
+
+     return value;
+}
+
+
+/*
+ * ----- Function: print_event() -----
+ */
+static void print_event(const char * ph, const char * name, int tid, double ts, const char * extra)
+{
+     printf("%s{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f%s%s}",
+            first_event ? "" : ",\n", ph, name, tid, ts, (NULL != extra) ? "," : "", (NULL != extra) ? extra : "");
+     first_event = 0;
+}
+
+
+/*
+ * ----- Function: print_track_name() -----
+ */
+static void print_track_name(int tid, const char * name)
+{
+     char extra[96];
+
+     sprintf(extra, "\"args\":{\"name\":\"%s\"}", name);
+     print_event("M", "thread_name", tid, 0.0, extra);
+}
+
+
+/*
+ * ----- Function: main() -----
+ */
+int main(int argc, char * argv[])
+{
+     FILE * file_ptr;
+     const char * file_name = NULL;
+     double cycles_per_us = 1.0;
+     unsigned long num_recs;
+     unsigned long num_lost;
+     unsigned long rec_size;
+     unsigned long mask;
+     unsigned long prev_time = 0;
+     unsigned long long now = 0;
+     unsigned long time;
+     unsigned long arg;
+     unsigned long n;
+     const unsigned char * rec_ptr;
+     unsigned long long flow;
+     int current_pid = -1;
+     int seen[256];
+     int type;
+     int id;
+     int tid;
+     double ts;
+     char name[64];
+     char extra[96];
+
+     // Parse the command line.
+     for(n = 1; n < (unsigned long)argc; n++)
+     {
+          if((0 == strcmp(argv[n], "-c")) && ((n + 1) < (unsigned long)argc))
+          {
+               cycles_per_us = atof(argv[++n]);
+          }
+          else
+          {
+               file_name = argv[n];
+          }
+     }
+
+     if((NULL == file_name) || (0.0 >= cycles_per_us))
+     {
+          fprintf(stderr, "usage: %s [-c cycles_per_us] dump.bin > trace.json\n", argv[0]);
+          return 1;
+     }
+
+     // Read the whole dump.
+     file_ptr = fopen(file_name, "rb");
+     if(NULL == file_ptr)
+     {
+          perror(file_name);
+          return 1;
+     }
+
+     fseek(file_ptr, 0, SEEK_END);
+     dump_size = ftell(file_ptr);
+     fseek(file_ptr, 0, SEEK_SET);
+
+     dump_ptr = (unsigned char *)malloc((size_t)dump_size + 1);
+     if((NULL == dump_ptr) || ((size_t)dump_size != fread(dump_ptr, 1, (size_t)dump_size, file_ptr)))
+     {
+          fprintf(stderr, "%s: read error\n", file_name);
+          return 1;
+     }
+     fclose(file_ptr);
+
+     // Check the header, the first port_uint_t after it is 1 and tells the byte order.
+     if((8 > dump_size) || (0 != memcmp(dump_ptr, "AETR", 4)) || (2 != dump_ptr[4]))
+     {
+          fprintf(stderr, "%s: not an AEDEA trace dump (version 2)\n", file_name);
+          return 1;
+     }
+
+     uint_size = dump_ptr[5];
+     rec_size = dump_ptr[6];
+     if(((2 != uint_size) && (4 != uint_size)) || (rec_size < ((2 * uint_size) + 2)) ||
+        (dump_size < (long)(8 + (3 * uint_size))))
+     {
+          fprintf(stderr, "%s: bad header\n", file_name);
+          return 1;
+     }
+
+     big_endian = 0;
+     if(1 != get_uint(dump_ptr + 8))
+     {
+          big_endian = 1;
+     }
+
+     num_recs = get_uint(dump_ptr + 8 + uint_size);
+     num_lost = get_uint(dump_ptr + 8 + (2 * uint_size));
+     if(dump_size < (long)(8 + (3 * uint_size) + (num_recs * rec_size)))
+     {
+          fprintf(stderr, "%s: truncated, %lu records expected\n", file_name, num_recs);
+          return 1;
+     }
+
+     mask = (2 == uint_size) ? 0xFFFFUL : 0xFFFFFFFFUL;
+     memset(seen, 0, sizeof(seen));
+
+     printf("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"records\":%lu,\"lost\":%lu},\"traceEvents\":[\n", num_recs, num_lost);
+     print_track_name(TID_TIMERS, "timers");
+     print_track_name(TID_CS, "critical sections");
+     print_track_name(TID_OTHER, "ISR / main");
+
+     rec_ptr = dump_ptr + 8 + (3 * uint_size);
+     for(n = 0; n < num_recs; n++, rec_ptr += rec_size)
+     {
+          time = get_uint(rec_ptr);
+          arg = get_uint(rec_ptr + uint_size);
+          type = rec_ptr[2 * uint_size];
+          id = rec_ptr[(2 * uint_size) + 1];
+
+          // The cycle counter wraps around, accumulate the differences.
+          if(0 != n)
+          {
+               now += (time - prev_time) & mask;
+          }
+          prev_time = time;
+          ts = (double)now / cycles_per_us;
+
+          // Name the track of each process the first time it is seen.
+          if(((TRACE_POST == type) || (TRACE_GET == type) || (TRACE_DISCARD == type) ||
+              (TRACE_DISPATCH_START == type) || (TRACE_DISPATCH_END == type)) &&
+             (0 == seen[id]))
+          {
+               seen[id] = 1;
+               sprintf(name, "process %d", id);
+               print_track_name(id, name);
+          }
+
+          tid = (0 <= current_pid) ? current_pid : TID_OTHER;
+
+          // An event is identified by its process and its sequence number in the process' queue.
+          flow = ((unsigned long long)id << 32) | arg;
+
+          switch(type)
+          {
+               case TRACE_POST:
+                    // Start a flow arrow on the posting context's track.
+                    sprintf(name, "post to %d", id);
+                    print_event("i", name, tid, ts, "\"s\":\"t\"");
+                    sprintf(extra, "\"id\":%llu,\"cat\":\"event\"", flow);
+                    print_event("s", "event", tid, ts, extra);
+                    break;
+
+               case TRACE_GET:
+               case TRACE_DISCARD:
+                    // End the event's flow arrow, a flow whose POST was overwritten is dropped
+                    // by the viewer.
+                    print_event("i", (TRACE_GET == type) ? "get" : "discard", id, ts, "\"s\":\"t\"");
+                    sprintf(extra, "\"id\":%llu,\"cat\":\"event\",\"bp\":\"e\"", flow);
+                    print_event("f", "event", id, ts, extra);
+                    break;
+
+               case TRACE_DISPATCH_START:
+                    print_event("B", "dispatch", id, ts, NULL);
+                    current_pid = id;
+                    break;
+
+               case TRACE_DISPATCH_END:
+                    print_event("E", "dispatch", id, ts, NULL);
+                    current_pid = -1;
+                    break;
+
+               case TRACE_TMR_INSTALL:
+                    sprintf(name, "install timer %d", id);
+                    sprintf(extra, "\"s\":\"t\",\"args\":{\"ticks\":%lu}", arg);
+                    print_event("i", name, TID_TIMERS, ts, extra);
+                    break;
+
+               case TRACE_TMR_EXPIRE:
+                    sprintf(name, "timer %d expired", id);
+                    print_event("i", name, TID_TIMERS, ts, "\"s\":\"t\"");
+                    break;
+
+               case TRACE_CS_ENTER:
+                    sprintf(extra, "\"args\":{\"line\":%lu}", arg);
+                    print_event("B", "critical section", TID_CS, ts, (0 != arg) ? extra : NULL);
+                    break;
+
+               case TRACE_CS_EXIT:
+                    print_event("E", "critical section", TID_CS, ts, NULL);
+                    break;
+
+               default:
+                    break;
+          }
+     }
+
+     printf("\n]}\n");
+
+     free(dump_ptr);
+
+     return 0;
+}